@@ -49,6 +49,8 @@ namespace core{
         
     char* BuddyTree::Allocate(unsigned int logarithmVal)
     {
+        if(logarithmVal > m_topCellLevel) //Larger than the whole tree
+            throw std::bad_alloc();
         unsigned int cellLevel = m_topCellLevel - logarithmVal, targetCellLevel = m_topCellLevel - logarithmVal;
         unsigned int cell = NON;
         while (cellLevel >= 0) {
@@ -67,7 +69,7 @@ namespace core{
         return BuddyCell::CalculateCellAddress(m_buffer, targetCellLevel, logarithmVal, cell);
     }
     
-    void BuddyTree::Deallocate(char *address)
+    unsigned int BuddyTree::Deallocate(char *address)
     {
         for(unsigned int cellLevelIdx = 0; cellLevelIdx <= m_topCellLevel; cellLevelIdx++)
         {
@@ -79,12 +81,25 @@ namespace core{
                 (*m_buddyTree)[cell] = NotAllocated;
                 IncreaseCellLevel(cellLevelIdx, 1);
                 MergeCells(cell);
-                return;
+                return m_topCellLevel - cellLevelIdx;
             }
         }
         throw std::bad_alloc();
     }
     
+    std::size_t BuddyTree::CollectFreeBlocks(std::vector<std::uint64_t>& freeBlocksPerOrder) const
+    {
+        std::size_t largestBlock = 0;
+        for(const auto& availableCells : m_availableCells)
+        {
+            unsigned int order = m_topCellLevel - availableCells.first;
+            if(order < freeBlocksPerOrder.size())
+                freeBlocksPerOrder[order] = static_cast<std::uint64_t>(availableCells.second);
+            largestBlock = std::max(largestBlock, static_cast<std::size_t>(1) << order);
+        }
+        return largestBlock;
+    }
+    
     void BuddyTree::MergeCells(unsigned int startingCell)
     {
         unsigned int cell = startingCell;
@@ -8,6 +8,7 @@
 #include <bitset>
 #include "SharedObject.h"
 #include "SymbolSet.h"
+#include "AllocatorStatistics.h"
 
 namespace core
 {
@@ -91,8 +92,16 @@ namespace core
             }
         }
         
+        //allocate is kept out of line, the sampled call site is its return address, which would otherwise
+        //be the caller's caller (or merged with other sites) once inlined.
+    #if defined(__GNUC__)
+        __attribute__((noinline))
+    #endif
         pointer allocate(size_type n, void * hint = nullptr )
         {
+        #if defined(__GNUC__)
+            m_impl->SampleCallSite(__builtin_return_address(0));
+        #endif
             return m_impl->allocate(n*sizeof(value_type), hint);
         }
         
@@ -101,6 +110,10 @@ namespace core
             m_impl->deallocate(p, n);
         }
         
+        AllocatorStatistics GetStatistics() const { return m_impl->GetStatistics(); }
+        //Every sampleRate'th allocation call site will be recorded, 0 disables the sampling.
+        void EnableCallSiteSampling(unsigned int sampleRate){ m_impl->EnableCallSiteSampling(sampleRate); }
+        
     private:
         template<typename T1> friend class Allocator;
         std::unique_ptr<AllocatorImpl<T>> m_impl;
@@ -119,6 +132,9 @@ namespace core
         
         virtual pointer allocate(size_type n, void * hint) = 0;
         virtual void deallocate(void* p, size_type n) = 0;
+        virtual AllocatorStatistics GetStatistics() const = 0;
+        virtual void EnableCallSiteSampling(unsigned int sampleRate) = 0;
+        virtual void SampleCallSite(void* callSite) = 0;
     };
     
     class BuddyCell
@@ -138,7 +154,10 @@ namespace core
         
         BuddyTree(unsigned int numCellsLevel, char* const buffer);
         char* Allocate(unsigned int cellLevelGuess);
-        void Deallocate(char* address);
+        //Deallocate returns the order (log2 of the block size) of the released block.
+        unsigned int Deallocate(char* address);
+        //CollectFreeBlocks fills the free blocks count per order and returns the largest allocatable block size.
+        std::size_t CollectFreeBlocks(std::vector<std::uint64_t>& freeBlocksPerOrder) const;
         
     private:
         enum BlockStatus : char
@@ -171,30 +190,39 @@ namespace core
         typedef typename base::pointer pointer;
         
         BuddySharedAllocator()
-            :m_owner(false)
+            :m_counters(nullptr), m_owner(false)
         {
         }
         
+        //The allocator counters are placed right past the buddy tree, outside of its power of 2 span, any process
+        //attaching to the same object will observe and update the same counters. the object is grown to hold both.
         BuddySharedAllocator(const std::string& name, std::ptrdiff_t offset, int chunkSize = 1024 * 1024)
-            :m_sharedObject(new SharedObject(name, SharedObject::AccessMod::READ_WRITE)), m_owner(true)
+            :m_sharedObject(new SharedObject(name, SharedObject::AccessMod::READ_WRITE)), m_sampler(new CallSiteSampler()), m_owner(true)
         {
-            m_sharedObject->Allocate(chunkSize);
-            m_region = m_sharedObject->Map(offset, chunkSize - offset, SharedObject::AccessMod::READ_WRITE);
+            VERIFY(chunkSize > offset, "The chunk must extend past the offset");
             unsigned int cellLevel = ceil(log2(chunkSize - offset));
+            std::size_t treeSize = static_cast<std::size_t>(1) << cellLevel;
+            m_sharedObject->Allocate(offset + treeSize + sizeof(AllocatorCounters));
+            m_region = m_sharedObject->Map(offset, treeSize + sizeof(AllocatorCounters), SharedObject::AccessMod::READ_WRITE);
+            m_counters = reinterpret_cast<AllocatorCounters*>(m_region.GetPtr() + treeSize);
+            m_counters->Attach();
             m_buddyTree.reset(new BuddyTree(cellLevel, m_region.GetPtr()));
         }
     
         explicit BuddySharedAllocator(char* const buffer, int chunkSize = 1024 * 1024)
-            :m_owner(false)
+            :m_localCounters(new AllocatorCounters()), m_sampler(new CallSiteSampler()), m_owner(false)
         {
-            unsigned int cellLevel = ceil(log2(chunkSize));
+            m_counters = m_localCounters.get();
+            m_counters->Attach();
+            unsigned int cellLevel = floor(log2(chunkSize));
             m_buddyTree.reset(new BuddyTree(cellLevel, buffer));
         }
         
         template<typename T1>
         BuddySharedAllocator(const BuddySharedAllocator<T1>& object)
             :m_sharedObject(object.m_sharedObject), m_region(object.m_region),
-                m_buddyTree(object.m_buddyTree), m_owner(false)
+                m_buddyTree(object.m_buddyTree), m_localCounters(object.m_localCounters), m_sampler(object.m_sampler),
+                m_counters(object.m_counters), m_owner(false)
         {}
         
         template<typename T1>
@@ -203,6 +231,9 @@ namespace core
             m_sharedObject = object.m_sharedObject;
             m_region = object.m_region;
             m_buddyTree = object.m_buddyTree;
+            m_localCounters = object.m_localCounters;
+            m_sampler = object.m_sampler;
+            m_counters = object.m_counters;
             m_owner = false;
             return *this;
         }
@@ -219,19 +250,44 @@ namespace core
         pointer allocate(size_type n, void * hint) override
         {
             unsigned int logarithmVal = ceil(log2(n));
-            return reinterpret_cast<pointer>(m_buddyTree->Allocate(logarithmVal));
+            try
+            {
+                pointer ptr = reinterpret_cast<pointer>(m_buddyTree->Allocate(logarithmVal));
+                m_counters->OnAllocate(logarithmVal);
+                return ptr;
+            }
+            catch(std::bad_alloc&)
+            {
+                m_counters->OnAllocationFailure();
+                throw;
+            }
         }
     
         void deallocate(void* p, size_type n) override
         {
-            m_buddyTree->Deallocate(reinterpret_cast<char*>(p));
+            m_counters->OnDeallocate(m_buddyTree->Deallocate(reinterpret_cast<char*>(p)));
         }
         
+        AllocatorStatistics GetStatistics() const override
+        {
+            AllocatorStatistics statistics;
+            statistics.Collect(*m_counters);
+            statistics.largestAllocatableBlock = m_buddyTree->CollectFreeBlocks(statistics.freeBlocksPerOrder);
+            statistics.callSites = m_sampler->GetHistogram();
+            return statistics;
+        }
+        
+        void EnableCallSiteSampling(unsigned int sampleRate) override { m_sampler->SetSampleRate(sampleRate); }
+        void SampleCallSite(void* callSite) override { m_sampler->Sample(callSite); }
+        
     private:
         template<typename T1> friend class BuddySharedAllocator;
         std::shared_ptr<BuddyTree> m_buddyTree;
         std::shared_ptr<SharedObject> m_sharedObject;
         SharedRegion m_region;
+        std::shared_ptr<AllocatorCounters> m_localCounters;
+        std::shared_ptr<CallSiteSampler> m_sampler;
+        AllocatorCounters* m_counters;
         mutable bool m_owner;
     };
 }
\ No newline at end of file
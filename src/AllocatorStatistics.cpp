@@ -0,0 +1,110 @@
+#include "AllocatorStatistics.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace core
+{
+    namespace
+    {
+        int64_t MonotonicNow()
+        {
+            return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    void AllocatorCounters::Attach()
+    {
+        int64_t notStarted = 0;
+        startTime.compare_exchange_strong(notStarted, MonotonicNow()); //Only the first attached process sets the start time
+    }
+
+    void AllocatorCounters::OnAllocate(unsigned int order)
+    {
+        uint64_t blockSize = static_cast<uint64_t>(1) << order;
+        allocations.fetch_add(1, memory_order_relaxed);
+        bytesInUsePerOrder[order].fetch_add(blockSize, memory_order_relaxed);
+        uint64_t inUse = bytesInUse.fetch_add(blockSize, memory_order_relaxed) + blockSize;
+        uint64_t highWater = highWaterMark.load(memory_order_relaxed);
+        while(inUse > highWater && highWaterMark.compare_exchange_weak(highWater, inUse, memory_order_relaxed) == false);
+    }
+
+    void AllocatorCounters::OnDeallocate(unsigned int order)
+    {
+        uint64_t blockSize = static_cast<uint64_t>(1) << order;
+        deallocations.fetch_add(1, memory_order_relaxed);
+        bytesInUsePerOrder[order].fetch_sub(blockSize, memory_order_relaxed);
+        bytesInUse.fetch_sub(blockSize, memory_order_relaxed);
+    }
+
+    void AllocatorCounters::OnAllocationFailure()
+    {
+        failedAllocations.fetch_add(1, memory_order_relaxed);
+    }
+
+    void CallSiteSampler::Sample(void* callSite)
+    {
+        unsigned int sampleRate = m_sampleRate.load(memory_order_relaxed);
+        if(sampleRate == 0 || m_counter.fetch_add(1, memory_order_relaxed) % sampleRate != 0)
+            return;
+
+        lock_guard<mutex> lock(m_mutex);
+        m_histogram[callSite]++;
+    }
+
+    vector<pair<void*, uint64_t>> CallSiteSampler::GetHistogram() const
+    {
+        vector<pair<void*, uint64_t>> histogram;
+        {
+            lock_guard<mutex> lock(m_mutex);
+            histogram.assign(m_histogram.begin(), m_histogram.end());
+        }
+        sort(histogram.begin(), histogram.end(), [](const pair<void*, uint64_t>& lhs, const pair<void*, uint64_t>& rhs){
+            return lhs.second > rhs.second;
+        });
+        return histogram;
+    }
+
+    AllocatorStatistics::AllocatorStatistics()
+        :allocations(0), deallocations(0), failedAllocations(0), bytesInUse(0), highWaterMark(0),
+         allocationRate(0), deallocationRate(0), largestAllocatableBlock(0),
+         bytesInUsePerOrder(AllocatorCounters::MaxOrder, 0), freeBlocksPerOrder(AllocatorCounters::MaxOrder, 0){}
+
+    void AllocatorStatistics::Collect(const AllocatorCounters& counters)
+    {
+        allocations = counters.allocations.load(memory_order_relaxed);
+        deallocations = counters.deallocations.load(memory_order_relaxed);
+        failedAllocations = counters.failedAllocations.load(memory_order_relaxed);
+        bytesInUse = counters.bytesInUse.load(memory_order_relaxed);
+        highWaterMark = counters.highWaterMark.load(memory_order_relaxed);
+        for(int order = 0; order < AllocatorCounters::MaxOrder; order++)
+            bytesInUsePerOrder[order] = counters.bytesInUsePerOrder[order].load(memory_order_relaxed);
+
+        int64_t startTime = counters.startTime.load(memory_order_relaxed);
+        double elapsedSeconds = startTime == 0 ? 0 : (MonotonicNow() - startTime) / 1e9;
+        allocationRate = elapsedSeconds > 0 ? allocations / elapsedSeconds : 0;
+        deallocationRate = elapsedSeconds > 0 ? deallocations / elapsedSeconds : 0;
+    }
+
+    string AllocatorStatistics::ToString() const
+    {
+        stringstream ss;
+        ss << "allocations=" << allocations << " deallocations=" << deallocations << " failed=" << failedAllocations
+           << " bytesInUse=" << bytesInUse << " highWaterMark=" << highWaterMark
+           << " allocationRate=" << allocationRate << "/s deallocationRate=" << deallocationRate << "/s"
+           << " largestAllocatableBlock=" << largestAllocatableBlock << "\n";
+        for(int order = 0; order < AllocatorCounters::MaxOrder; order++)
+        {
+            if(bytesInUsePerOrder[order] == 0 && freeBlocksPerOrder[order] == 0)
+                continue;
+            ss << "order " << order << " (" << (static_cast<uint64_t>(1) << order) << " bytes): inUse="
+               << bytesInUsePerOrder[order] << " bytes, free=" << freeBlocksPerOrder[order] << " blocks\n";
+        }
+        for(const auto& callSite : callSites)
+            ss << "call site " << callSite.first << ": " << callSite.second << " samples\n";
+        return ss.str();
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace core
+{
+    //AllocatorCounters is the raw counters block of an allocator, all members are atomics which are valid when
+    //zero filled, making it legit to place the block at the head of a shared region (a freshly truncated shared object)
+    //and let any attached process update or dump it without taking a lock.
+    struct AllocatorCounters
+    {
+        static const int MaxOrder = 64;
+
+        void Attach();
+        void OnAllocate(unsigned int order);
+        void OnDeallocate(unsigned int order);
+        void OnAllocationFailure();
+
+        std::atomic<std::uint64_t> allocations;
+        std::atomic<std::uint64_t> deallocations;
+        std::atomic<std::uint64_t> failedAllocations;
+        std::atomic<std::uint64_t> bytesInUse;
+        std::atomic<std::uint64_t> highWaterMark;
+        std::atomic<std::int64_t> startTime; //Monotonic clock in nanoseconds, shared between processes.
+        std::atomic<std::uint64_t> bytesInUsePerOrder[MaxOrder]; //Block size of order i is 2^i
+    };
+
+    //CallSiteSampler records every n'th allocation call site, the histogram is process local and is
+    //disabled by default (a sample rate of 0).
+    class CallSiteSampler
+    {
+    public:
+        CallSiteSampler(): m_sampleRate(0), m_counter(0){}
+        void SetSampleRate(unsigned int sampleRate){ m_sampleRate = sampleRate; }
+        void Sample(void* callSite);
+        std::vector<std::pair<void*, std::uint64_t>> GetHistogram() const;
+
+    private:
+        std::atomic<unsigned int> m_sampleRate;
+        std::atomic<std::uint64_t> m_counter;
+        std::unordered_map<void*, std::uint64_t> m_histogram;
+        mutable std::mutex m_mutex;
+    };
+
+    //AllocatorStatistics is a point in time snapshot of an allocator, per order vectors are indexed by the block order.
+    struct AllocatorStatistics
+    {
+        AllocatorStatistics();
+        void Collect(const AllocatorCounters& counters);
+        std::string ToString() const;
+
+        std::uint64_t allocations;
+        std::uint64_t deallocations;
+        std::uint64_t failedAllocations;
+        std::uint64_t bytesInUse;
+        std::uint64_t highWaterMark;
+        double allocationRate; //Per second since the counters were attached
+        double deallocationRate;
+        std::size_t largestAllocatableBlock;
+        std::vector<std::uint64_t> bytesInUsePerOrder;
+        std::vector<std::uint64_t> freeBlocksPerOrder;
+        std::vector<std::pair<void*, std::uint64_t>> callSites; //Sorted by descending hit count
+    };
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include "SymbolSet.h"
+#include "Assert.h"
+
+namespace core{
+
+    //AtomicSymbolset is the concurrent counterpart of Symbolset, each symbol is updated by a CAS loop on the word
+    //containing it, so updates of neighbouring symbols never corrupt each other. SymbolSize must divide the word size,
+    //ensuring a symbol never crosses a word. the words may be placed within a shared region (see chunk_size), in
+    //which case the set is usable across processes.
+    template<std::size_t SymbolSize>
+    class AtomicSymbolset
+    {
+    public:
+        static_assert(WORD_BIT_COUNT % SymbolSize == 0, "Symbol size must divide the word size");
+        static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Lock free 64 bit atomics are required for process shared usage");
+        typedef std::uint64_t value_type;
+        static constexpr std::uint64_t SymbolMask = Symbol<SymbolSize>::SymbolMask;
+
+        explicit AtomicSymbolset(std::size_t numOfSymbols)
+            :m_numOfSymbols(numOfSymbols), m_owner(true)
+        {
+            m_words = new std::atomic<std::uint64_t>[WordCount(numOfSymbols)];
+            for(std::size_t idx = 0; idx < WordCount(numOfSymbols); idx++)
+                m_words[idx].store(0, std::memory_order_relaxed);
+        }
+
+        //The owner initializes the words within buffer, the rest attach to an already initialized buffer.
+        AtomicSymbolset(char* buffer, std::size_t numOfSymbols, bool owner)
+            :m_numOfSymbols(numOfSymbols), m_owner(false)
+        {
+            VERIFY(reinterpret_cast<std::uintptr_t>(buffer) % alignof(std::atomic<std::uint64_t>) == 0, "buffer is not word aligned");
+            m_words = reinterpret_cast<std::atomic<std::uint64_t>*>(buffer);
+            if(owner)
+            {
+                for(std::size_t idx = 0; idx < WordCount(numOfSymbols); idx++)
+                    new(&m_words[idx])std::atomic<std::uint64_t>(0);
+            }
+        }
+
+        AtomicSymbolset(const AtomicSymbolset&) = delete;
+        AtomicSymbolset& operator=(const AtomicSymbolset&) = delete;
+
+        ~AtomicSymbolset()
+        {
+            if(m_owner)
+                delete [] m_words;
+        }
+
+        static constexpr std::size_t chunk_size(std::size_t numOfSymbols)
+        {
+            return WordCount(numOfSymbols) * sizeof(std::atomic<std::uint64_t>);
+        }
+
+        std::size_t Size() const { return m_numOfSymbols; }
+
+        value_type Load(std::size_t index, std::memory_order order = std::memory_order_seq_cst) const
+        {
+            return (Word(index).load(order) >> Shift(index)) & SymbolMask;
+        }
+
+        void Store(std::size_t index, value_type value, std::memory_order order = std::memory_order_seq_cst)
+        {
+            FetchUpdate(index, [value](value_type){ return value; }, order);
+        }
+
+        value_type Exchange(std::size_t index, value_type value, std::memory_order order = std::memory_order_seq_cst)
+        {
+            return FetchUpdate(index, [value](value_type){ return value; }, order);
+        }
+
+        //CompareExchange replaces the symbol with desired if it equals expected, else expected is loaded with the current value.
+        bool CompareExchange(std::size_t index, value_type& expected, value_type desired,
+                             std::memory_order order = std::memory_order_seq_cst)
+        {
+            std::atomic<std::uint64_t>& word = Word(index);
+            unsigned int shift = Shift(index);
+            std::uint64_t current = word.load(std::memory_order_relaxed);
+            while(true)
+            {
+                value_type symbol = (current >> shift) & SymbolMask;
+                if(symbol != (expected & SymbolMask))
+                {
+                    expected = symbol;
+                    return false;
+                }
+                std::uint64_t updated = (current & ~(SymbolMask << shift)) | ((desired & SymbolMask) << shift);
+                if(word.compare_exchange_weak(current, updated, order, std::memory_order_relaxed))
+                    return true;
+            }
+        }
+
+        //Fetch operations return the previous symbol value, FetchAdd wraps around within the symbol bits.
+        value_type FetchAdd(std::size_t index, value_type delta, std::memory_order order = std::memory_order_seq_cst)
+        {
+            return FetchUpdate(index, [delta](value_type symbol){ return symbol + delta; }, order);
+        }
+
+        value_type FetchSub(std::size_t index, value_type delta, std::memory_order order = std::memory_order_seq_cst)
+        {
+            return FetchUpdate(index, [delta](value_type symbol){ return symbol - delta; }, order);
+        }
+
+        value_type FetchOr(std::size_t index, value_type mask, std::memory_order order = std::memory_order_seq_cst)
+        {
+            return FetchUpdate(index, [mask](value_type symbol){ return symbol | mask; }, order);
+        }
+
+        value_type FetchAnd(std::size_t index, value_type mask, std::memory_order order = std::memory_order_seq_cst)
+        {
+            return FetchUpdate(index, [mask](value_type symbol){ return symbol & mask; }, order);
+        }
+
+        //FetchUpdate applies func over the current symbol value until the result is published without interference.
+        template<typename Func>
+        value_type FetchUpdate(std::size_t index, const Func& func, std::memory_order order = std::memory_order_seq_cst)
+        {
+            std::atomic<std::uint64_t>& word = Word(index);
+            unsigned int shift = Shift(index);
+            std::uint64_t current = word.load(std::memory_order_relaxed);
+            while(true)
+            {
+                value_type symbol = (current >> shift) & SymbolMask;
+                std::uint64_t updated = (current & ~(SymbolMask << shift)) | ((func(symbol) & SymbolMask) << shift);
+                if(word.compare_exchange_weak(current, updated, order, std::memory_order_relaxed))
+                    return symbol;
+            }
+        }
+
+    private:
+        static const std::size_t SymbolsPerWord = WORD_BIT_COUNT / SymbolSize;
+
+        static constexpr std::size_t WordCount(std::size_t numOfSymbols)
+        {
+            return (numOfSymbols + SymbolsPerWord - 1) / SymbolsPerWord;
+        }
+
+        std::atomic<std::uint64_t>& Word(std::size_t index) const { return m_words[index / SymbolsPerWord]; }
+        static unsigned int Shift(std::size_t index) { return static_cast<unsigned int>((index % SymbolsPerWord) * SymbolSize); }
+
+    private:
+        std::size_t m_numOfSymbols;
+        std::atomic<std::uint64_t>* m_words;
+        bool m_owner;
+    };
+
+    template<std::size_t SymbolSize>
+    constexpr std::uint64_t AtomicSymbolset<SymbolSize>::SymbolMask;
+}
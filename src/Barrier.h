@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <limits>
+#include <cstdint>
+#include "Futex.h"
+#include "Cpu.h"
+
+namespace core{
+
+    //Barrier is a reusable, phase counted barrier for a fixed number of participants. the last participant to
+    //arrive opens the next phase and releases everyone with a single futex call, skipped if no one sleeps. all of
+    //its state resides within the object, making it usable in shared memory (unless constructed with
+    //Futex::Scope::PRIVATE), e.g. to synchronize process workers phases.
+    class Barrier
+    {
+    public:
+        explicit Barrier(int participants, Futex::Scope scope = Futex::Scope::SHARED)
+            : m_participants(participants), m_arrived(0), m_phase(0), m_sleepers(0), m_scope(scope){}
+        Barrier(const Barrier&) = delete;
+        Barrier& operator=(const Barrier&) = delete;
+
+        //arrive_and_wait returns the phase which was completed.
+        std::uint32_t arrive_and_wait()
+        {
+            std::uint32_t phase = m_phase.load(std::memory_order_acquire);
+            if(m_arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == m_participants)
+            {
+                m_arrived.store(0, std::memory_order_relaxed);
+                m_phase.fetch_add(1, std::memory_order_seq_cst);
+                if(m_sleepers.load(std::memory_order_seq_cst) != 0)
+                    Futex::Wake(&m_phase, std::numeric_limits<int>::max(), m_scope);
+                return phase;
+            }
+
+            const int spinCount = 100;
+            for(int spin = 0; m_phase.load(std::memory_order_acquire) == phase; spin++)
+            {
+                if(spin < spinCount)
+                {
+                    CpuRelax();
+                    continue;
+                }
+                m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+                if(m_phase.load(std::memory_order_seq_cst) == phase)
+                    Futex::Wait(&m_phase, static_cast<int>(phase), m_scope);
+                m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+            }
+            return phase;
+        }
+
+        std::uint32_t get_phase() const
+        {
+            return m_phase.load(std::memory_order_acquire);
+        }
+
+    private:
+        const int m_participants;
+        std::atomic<int> m_arrived;
+        std::atomic<std::uint32_t> m_phase;
+        std::atomic<int> m_sleepers;
+        const Futex::Scope m_scope;
+    };
+}
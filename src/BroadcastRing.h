@@ -0,0 +1,191 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <cstdint>
+#include <type_traits>
+#include "SharedObject.h"
+#include "Futex.h"
+#include "Exception.h"
+
+namespace core{
+
+    //BroadcastRing is a single writer, multiple readers ring placed in shared memory, every element is observed by
+    //every reader. the writer never blocks, it overwrites the oldest element and wakes parked readers with a single
+    //futex call (only when any reader is parked), so publishing cost doesn't depend on the number of readers.
+    //each reader tracks its own cursor, a reader which was lapped by the writer detects it through the slot sequence
+    //and skips to the oldest element still available.
+    template<typename Type, std::size_t Count>
+    class BroadcastRing
+    {
+    public:
+        static_assert(std::is_trivially_copyable<Type>::value, "Elements are copied while they may be overwritten, Type must be trivially copyable");
+        static_assert(Count > 0 && (Count & (Count - 1)) == 0, "Count must be a power of 2");
+        typedef Type value_type;
+        typedef BroadcastRing<Type, Count> _self;
+
+        enum class ReadStatus
+        {
+            OK,
+            EMPTY,
+            OVERRUN //Elements were lost, the reader skipped to the oldest available element
+        };
+
+        //Reader is a process local cursor, a newly made reader observes elements published from now on.
+        class Reader
+        {
+        public:
+            std::uint64_t GetCursor() const { return m_cursor; }
+            std::uint64_t GetLostCount() const { return m_lostCount; }
+
+        private:
+            friend class BroadcastRing;
+            explicit Reader(std::uint64_t cursor): m_cursor(cursor), m_lostCount(0){}
+            std::uint64_t m_cursor;
+            std::uint64_t m_lostCount;
+        };
+
+        BroadcastRing(const std::string& name, bool owner, SharedObject::AccessMod mod, std::size_t offset = 0)
+            :m_sharedObject(new SharedObject(name, mod)), m_owner(owner)
+        {
+            std::size_t chunkSize = _self::chunk_size();
+            m_sharedObject->Allocate(chunkSize + offset);
+            m_region = m_sharedObject->Map(offset, chunkSize, mod);
+            Init(m_region.GetPtr());
+        }
+
+        BroadcastRing(char* buffer, bool owner)
+            :m_owner(owner)
+        {
+            Init(buffer);
+        }
+
+        ~BroadcastRing()
+        {
+            m_region.UnMap();
+            if(m_sharedObject && m_owner)
+                m_sharedObject->Unlink();
+        }
+
+        static constexpr std::size_t chunk_size()
+        {
+            return sizeof(Header) + Count * sizeof(Slot);
+        }
+
+        Reader make_reader() const
+        {
+            return Reader(m_header->writeSeq.load(std::memory_order_acquire));
+        }
+
+        //publish must be called by a single writer at a time.
+        void publish(const Type& element)
+        {
+            std::uint64_t seq = m_header->writeSeq.load(std::memory_order_relaxed);
+            Slot& slot = m_slots[seq & (Count - 1)];
+            slot.version.store(seq * 2 + 1, std::memory_order_relaxed); //Odd - being written
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.element = element;
+            slot.version.store(seq * 2 + 2, std::memory_order_release);
+            m_header->writeSeq.store(seq + 1, std::memory_order_seq_cst);
+            if(m_header->parkedReaders.load(std::memory_order_seq_cst) != 0)
+            {
+                m_header->wakeGeneration.fetch_add(1, std::memory_order_seq_cst);
+                Futex::Wake(&m_header->wakeGeneration, std::numeric_limits<int>::max(), Futex::Scope::SHARED); //Readers may reside in other processes
+            }
+        }
+
+        ReadStatus try_read(Reader& reader, Type& element) const
+        {
+            while(true)
+            {
+                const Slot& slot = m_slots[reader.m_cursor & (Count - 1)];
+                std::uint64_t expectedVersion = reader.m_cursor * 2 + 2;
+                std::uint64_t version = slot.version.load(std::memory_order_acquire);
+                if(version < expectedVersion)
+                    return ReadStatus::EMPTY;
+                if(version == expectedVersion)
+                {
+                    element = slot.element;
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if(slot.version.load(std::memory_order_relaxed) == expectedVersion)
+                    {
+                        reader.m_cursor++;
+                        return ReadStatus::OK;
+                    }
+                }
+                //The writer lapped the reader, skipping to the oldest element which is not being overwritten.
+                std::uint64_t writeSeq = m_header->writeSeq.load(std::memory_order_acquire);
+                std::uint64_t oldest = writeSeq >= Count ? writeSeq - Count + 1 : 0;
+                if(oldest > reader.m_cursor)
+                {
+                    reader.m_lostCount += oldest - reader.m_cursor;
+                    reader.m_cursor = oldest;
+                    return ReadStatus::OVERRUN;
+                }
+            }
+        }
+
+        //read blocks until an element is available, spinning shortly before parking on a futex.
+        ReadStatus read(Reader& reader, Type& element) const
+        {
+            const int spinCount = 100;
+            while(true)
+            {
+                for(int spin = 0; spin < spinCount; spin++)
+                {
+                    ReadStatus status = try_read(reader, element);
+                    if(status != ReadStatus::EMPTY)
+                        return status;
+                }
+
+                m_header->parkedReaders.fetch_add(1, std::memory_order_seq_cst);
+                int generation = m_header->wakeGeneration.load(std::memory_order_seq_cst);
+                if(m_header->writeSeq.load(std::memory_order_seq_cst) <= reader.m_cursor)
+                    Futex::Wait(&m_header->wakeGeneration, generation, Futex::Scope::SHARED);
+                m_header->parkedReaders.fetch_sub(1, std::memory_order_seq_cst);
+            }
+        }
+
+    private:
+        struct Header
+        {
+            alignas(64) std::atomic<std::uint64_t> writeSeq; //Next sequence to publish
+            alignas(64) std::atomic<int> wakeGeneration;
+            std::atomic<int> parkedReaders;
+        };
+
+        struct alignas(64) Slot
+        {
+            std::atomic<std::uint64_t> version; //2 * seq + 2 once seq was published
+            Type element;
+        };
+
+        void Init(char* buffer)
+        {
+            if(m_owner)
+            {
+                m_header = new(buffer)Header();
+                m_header->writeSeq.store(0);
+                m_header->wakeGeneration.store(0);
+                m_header->parkedReaders.store(0);
+                m_slots = reinterpret_cast<Slot*>(buffer + sizeof(Header));
+                for(std::size_t idx = 0; idx < Count; idx++)
+                    new(&m_slots[idx].version)std::atomic<std::uint64_t>(0);
+            }
+            else
+            {
+                m_header = reinterpret_cast<Header*>(buffer);
+                m_slots = reinterpret_cast<Slot*>(buffer + sizeof(Header));
+            }
+        }
+
+    private:
+        std::unique_ptr<SharedObject> m_sharedObject;
+        SharedRegion m_region;
+        Header* m_header;
+        Slot* m_slots;
+        bool m_owner;
+    };
+}
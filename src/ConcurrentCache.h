@@ -0,0 +1,382 @@
+#pragma once
+
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <shared_mutex>
+#include <future>
+#include <atomic>
+#include <chrono>
+#include <tuple>
+#include <thread>
+#include <cstdint>
+#include "Exception.h"
+#include "RWMutex.h"
+
+namespace core
+{
+    //ConcurrentCache is a bounded cache, split into shards like ConcurrentDictionary, each shard evicts by CLOCK.
+    //a hit takes only the shard's RWMutex in shared mode and marks the entry as referenced, (nothing is relinked,
+    //unlike LRU), the eviction hand spares referenced entries once. entries may carry a time to live, an expired entry
+    //is a miss and is evicted first. GetOrCompute coalesces concurrent misses of a key into a single load.
+    template <typename Key, typename Value, typename Hash = std::hash<Key>>
+    class ConcurrentCache
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+        static const std::size_t DefaultShardsCount = 16;
+
+        struct Statistics
+        {
+            std::uint64_t hits;
+            std::uint64_t misses;
+            std::uint64_t evictions; //Entries evicted to make room
+            std::uint64_t expirations; //Expired entries evicted
+        };
+
+        //capacity is split between the shards, the cache never holds more than capacity entries. shardsCount is
+        //rounded up to a power of 2, and down to capacity's so that no shard is left empty, a zero ttl never expires.
+        explicit ConcurrentCache(std::size_t capacity, Clock::duration ttl = Clock::duration::zero(),
+            std::size_t shardsCount = DefaultShardsCount)
+            :m_shardBits(0), m_ttl(ttl)
+        {
+            if(capacity == 0)
+                throw Exception(__CORE_SOURCE, "Cache capacity must be positive");
+            while((static_cast<std::size_t>(1) << m_shardBits) < shardsCount)
+                m_shardBits++;
+            while((static_cast<std::size_t>(1) << m_shardBits) > capacity)
+                m_shardBits--;
+            m_shardsCount = static_cast<std::size_t>(1) << m_shardBits;
+            m_buffer.reset(new char[m_shardsCount * sizeof(Shard) + CacheLineSize]);
+            std::uintptr_t address = reinterpret_cast<std::uintptr_t>(m_buffer.get());
+            m_shards = reinterpret_cast<Shard*>((address + CacheLineSize - 1) & ~(static_cast<std::uintptr_t>(CacheLineSize) - 1));
+            for(std::size_t idx = 0; idx < m_shardsCount; idx++) //The remainder goes to the first shards, one each
+                new(&m_shards[idx])Shard(capacity / m_shardsCount + (idx < capacity % m_shardsCount ? 1 : 0));
+        }
+        ConcurrentCache(const ConcurrentCache&) = delete;
+        ConcurrentCache& operator=(const ConcurrentCache&) = delete;
+        ~ConcurrentCache()
+        {
+            for(std::size_t idx = 0; idx < m_shardsCount; idx++)
+                m_shards[idx].~Shard();
+        }
+        //TryGetValue copies the key's value into value, returns false if the key is missing or has expired.
+        bool TryGetValue(const Key& key, Value& value) const
+        {
+            Shard& shard = GetShard(key);
+            std::shared_lock<RWMutex> localLock(shard.mutex);
+            const Value* cached = Lookup(shard, key, Now());
+            Count(shard, cached != nullptr);
+            if(cached == nullptr)
+                return false;
+            value = *cached;
+            return true;
+        }
+
+        void SetValue(const Key& key, const Value& value)
+        {
+            SetValue(key, value, m_ttl);
+        }
+
+        void SetValue(const Key& key, const Value& value, Clock::duration ttl)
+        {
+            Shard& shard = GetShard(key);
+            std::unique_lock<RWMutex> localLock(shard.mutex);
+            Invalidate(shard, key);
+            Store(shard, key, value, ExpiryOf(ttl));
+        }
+
+        //RemoveValue returns false if the key isn't cached.
+        bool RemoveValue(const Key& key)
+        {
+            Shard& shard = GetShard(key);
+            std::unique_lock<RWMutex> localLock(shard.mutex);
+            Invalidate(shard, key);
+            auto it = shard.entries.find(key);
+            if(it == shard.entries.end())
+                return false;
+            Erase(shard, it);
+            return true;
+        }
+
+        template<typename Loader>
+        Value GetOrCompute(const Key& key, const Loader& loader)
+        {
+            return GetOrCompute(key, loader, m_ttl);
+        }
+
+        //GetOrCompute returns the cached value, on a miss the first caller invokes loader and caches its result
+        //while concurrent callers of the same key wait for it, an exception thrown by loader is rethrown to all of them.
+        //a SetValue or RemoveValue of the key made during the load prevails, the loaded value is returned but not cached.
+        template<typename Loader>
+        Value GetOrCompute(const Key& key, const Loader& loader, Clock::duration ttl)
+        {
+            Shard& shard = GetShard(key);
+            {
+                std::shared_lock<RWMutex> localLock(shard.mutex);
+                const Value* cached = Lookup(shard, key, Now());
+                Count(shard, cached != nullptr);
+                if(cached)
+                    return *cached;
+            }
+
+            std::promise<Value> promise;
+            {
+                std::unique_lock<RWMutex> localLock(shard.mutex);
+                if(const Value* cached = Lookup(shard, key, Now())) //Loaded meanwhile
+                    return *cached;
+                auto it = shard.loads.find(key);
+                if(it != shard.loads.end())
+                {
+                    std::shared_future<Value> load = it->second.future;
+                    localLock.unlock();
+                    return load.get();
+                }
+                shard.loads.emplace(key, Load(promise.get_future().share()));
+            }
+
+            Value value(Compute(shard, key, loader, promise));
+            {
+                std::unique_lock<RWMutex> localLock(shard.mutex);
+                auto it = shard.loads.find(key);
+                if(it->second.invalidated == false)
+                    Store(shard, key, value, ExpiryOf(ttl));
+                shard.loads.erase(it);
+            }
+            promise.set_value(value);
+            return value;
+        }
+
+        Statistics GetStatistics() const
+        {
+            Statistics statistics = Statistics();
+            for(std::size_t idx = 0; idx < m_shardsCount; idx++)
+            {
+                for(const Stripe& stripe : m_shards[idx].stripes)
+                {
+                    statistics.hits += stripe.hits.load(std::memory_order_relaxed);
+                    statistics.misses += stripe.misses.load(std::memory_order_relaxed);
+                }
+                statistics.evictions += m_shards[idx].evictions.load(std::memory_order_relaxed);
+                statistics.expirations += m_shards[idx].expirations.load(std::memory_order_relaxed);
+            }
+            return statistics;
+        }
+
+        std::size_t GetSize() const
+        {
+            std::size_t size = 0;
+            for(std::size_t idx = 0; idx < m_shardsCount; idx++)
+            {
+                std::shared_lock<RWMutex> localLock(m_shards[idx].mutex);
+                size += m_shards[idx].entries.size();
+            }
+            return size;
+        }
+
+        std::size_t GetShardsCount() const { return m_shardsCount; }
+
+    private:
+        static const std::size_t CacheLineSize = 64;
+
+        struct Entry
+        {
+            Entry(const Value& value, std::int64_t expiry, std::size_t slot): value(value), expiry(expiry), slot(slot), referenced(false){}
+            Value value;
+            std::int64_t expiry; //Clock ticks, 0 never expires
+            std::size_t slot; //Position within the clock
+            mutable std::atomic<bool> referenced;
+        };
+
+        typedef std::unordered_map<Key, Entry, Hash> Entries;
+
+        struct Load
+        {
+            explicit Load(const std::shared_future<Value>& future): future(future), invalidated(false){}
+            std::shared_future<Value> future;
+            bool invalidated; //The key was set or removed meanwhile, the loaded value is stale
+        };
+
+        //Stripe counts the hits and misses of the threads assigned to it, on a cache line of its own (as RWMutex's slots),
+        //readers of a shard don't contend over a single counter.
+        struct alignas(64) Stripe
+        {
+            std::atomic<std::uint64_t> hits;
+            std::atomic<std::uint64_t> misses;
+        };
+        static const std::size_t StripesCount = 16;
+
+        struct alignas(64) Shard
+        {
+            explicit Shard(std::size_t capacity): mutex(Futex::Scope::PRIVATE), capacity(capacity), hand(0), nextExpiry(0),
+                evictions(0), expirations(0)
+            {
+                clock.reserve(capacity);
+                for(Stripe& stripe : stripes)
+                {
+                    stripe.hits.store(0, std::memory_order_relaxed);
+                    stripe.misses.store(0, std::memory_order_relaxed);
+                }
+            }
+            mutable RWMutex mutex;
+            Entries entries;
+            std::vector<typename Entries::value_type*> clock; //Entries are node based, their addresses are stable
+            std::unordered_map<Key, Load, Hash> loads; //In flight GetOrCompute loads
+            const std::size_t capacity;
+            std::size_t hand;
+            std::int64_t nextExpiry; //No entry expires before, 0 if none may expire
+            Stripe stripes[StripesCount];
+            std::atomic<std::uint64_t> evictions; //Updated under the exclusive lock, read by GetStatistics
+            std::atomic<std::uint64_t> expirations;
+        };
+
+        //Invalidate keeps an in flight load of the key from overwriting a newer value or removal.
+        static void Invalidate(Shard& shard, const Key& key)
+        {
+            if(shard.loads.empty())
+                return;
+            auto it = shard.loads.find(key);
+            if(it != shard.loads.end())
+                it->second.invalidated = true;
+        }
+
+        //Lookup must be called under the shard's lock, shared mode suffices, the value is valid while it's held.
+        static const Value* Lookup(Shard& shard, const Key& key, std::int64_t now)
+        {
+            auto it = shard.entries.find(key);
+            if(it == shard.entries.end() || Expired(it->second, now))
+                return nullptr;
+            if(it->second.referenced.load(std::memory_order_relaxed) == false) //Avoids dirtying the line on repeated hits
+                it->second.referenced.store(true, std::memory_order_relaxed);
+            return &it->second.value;
+        }
+
+        static void Count(Shard& shard, bool hit)
+        {
+            static thread_local std::size_t index = std::hash<std::thread::id>()(std::this_thread::get_id()) % StripesCount;
+            Stripe& stripe = shard.stripes[index];
+            (hit ? stripe.hits : stripe.misses).fetch_add(1, std::memory_order_relaxed);
+        }
+
+        //Compute invokes loader, on a failure the load is withdrawn and its waiters get the exception.
+        template<typename Loader>
+        static Value Compute(Shard& shard, const Key& key, const Loader& loader, std::promise<Value>& promise)
+        {
+            try
+            {
+                return loader();
+            }
+            catch(...)
+            {
+                std::unique_lock<RWMutex> localLock(shard.mutex);
+                shard.loads.erase(key);
+                localLock.unlock();
+                promise.set_exception(std::current_exception());
+                throw;
+            }
+        }
+
+        static void Store(Shard& shard, const Key& key, const Value& value, std::int64_t expiry)
+        {
+            if(expiry != 0 && (shard.nextExpiry == 0 || expiry < shard.nextExpiry))
+                shard.nextExpiry = expiry;
+            auto it = shard.entries.find(key);
+            if(it != shard.entries.end())
+            {
+                it->second.value = value;
+                it->second.expiry = expiry;
+                it->second.referenced.store(true, std::memory_order_relaxed);
+                return;
+            }
+            if(shard.clock.size() == shard.capacity)
+                Evict(shard);
+            it = shard.entries.emplace(std::piecewise_construct, std::forward_as_tuple(key),
+                std::forward_as_tuple(value, expiry, shard.clock.size())).first;
+            shard.clock.push_back(&*it);
+        }
+
+        //Evict purges the expired entries, if any, otherwise sweeps the clock from its hand, clearing referenced entries
+        //until an unreferenced one is found.
+        static void Evict(Shard& shard)
+        {
+            std::int64_t now = Now();
+            if(shard.nextExpiry != 0 && shard.nextExpiry <= now && PurgeExpired(shard, now) != 0)
+                return;
+            while(true)
+            {
+                if(shard.hand >= shard.clock.size())
+                    shard.hand = 0;
+                Entry& entry = shard.clock[shard.hand]->second;
+                if(entry.referenced.load(std::memory_order_relaxed) == false)
+                    break;
+                entry.referenced.store(false, std::memory_order_relaxed);
+                shard.hand++;
+            }
+            shard.evictions.fetch_add(1, std::memory_order_relaxed);
+            Erase(shard, shard.entries.find(shard.clock[shard.hand]->first));
+        }
+
+        //PurgeExpired erases every expired entry and recomputes the shard's next expiry, returns the erased count.
+        static std::size_t PurgeExpired(Shard& shard, std::int64_t now)
+        {
+            std::size_t purged = 0;
+            shard.nextExpiry = 0;
+            for(std::size_t slot = shard.clock.size(); slot-- > 0;) //Erase fills the slot from the back, already visited
+            {
+                const Entry& entry = shard.clock[slot]->second;
+                if(Expired(entry, now))
+                {
+                    Erase(shard, shard.entries.find(shard.clock[slot]->first));
+                    purged++;
+                }
+                else if(entry.expiry != 0 && (shard.nextExpiry == 0 || entry.expiry < shard.nextExpiry))
+                    shard.nextExpiry = entry.expiry;
+            }
+            shard.expirations.fetch_add(purged, std::memory_order_relaxed);
+            return purged;
+        }
+
+        //Erase moves the clock's last entry into the erased entry's slot.
+        static void Erase(Shard& shard, typename Entries::iterator it)
+        {
+            std::size_t slot = it->second.slot;
+            shard.clock[slot] = shard.clock.back();
+            shard.clock[slot]->second.slot = slot;
+            shard.clock.pop_back();
+            shard.entries.erase(it);
+        }
+
+        static bool Expired(const Entry& entry, std::int64_t now)
+        {
+            return entry.expiry != 0 && entry.expiry <= now;
+        }
+
+        static std::int64_t Now()
+        {
+            return Clock::now().time_since_epoch().count();
+        }
+
+        static std::int64_t ExpiryOf(Clock::duration ttl)
+        {
+            return ttl == Clock::duration::zero() ? 0 : Now() + ttl.count();
+        }
+
+        //GetShard picks the shard by the high bits of the (fibonacci mixed) hash, the shard's table uses the low ones.
+        Shard& GetShard(const Key& key) const
+        {
+            if(m_shardBits == 0)
+                return m_shards[0];
+            std::uint64_t hash = static_cast<std::uint64_t>(Hash()(key)) * 0x9E3779B97F4A7C15ULL;
+            return m_shards[hash >> (64 - m_shardBits)];
+        }
+
+    private:
+        unsigned int m_shardBits;
+        std::size_t m_shardsCount;
+        const Clock::duration m_ttl;
+        std::unique_ptr<char[]> m_buffer;
+        Shard* m_shards;
+    };
+}
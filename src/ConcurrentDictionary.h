@@ -1,61 +1,189 @@
 #pragma once
 
-#include <map>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <vector>
 #include <mutex>
+#include <utility>
+#include <algorithm>
+#include <numeric>
+#include <cstdint>
 #include "Exception.h"
+#include "LockProfiler.h"
 
 namespace core
 {
     //Concurrentdictionary represents a minimal synchronise dictioary, with the following capabilities:
     //1) Add, retrieve, and remove a value by a given key.
     //2) Determine if a specific value exists by a given key.
-    template <typename Key, typename Value>
+    //the dictionary is split into shards, each a hash table guarded by its own lock, a key's shard is picked by its hash,
+    //so operations over different shards don't contend. shards are cache line aligned, their locks never share a line.
+    template <typename Key, typename Value, typename Hash = std::hash<Key>>
     class ConcurrentDictionary
     {
     public:
-        ConcurrentDictionary(){}
-        ~ConcurrentDictionary(){}
+        static const std::size_t DefaultShardsCount = 16;
+
+        //shardsCount is rounded up to a power of 2.
+        explicit ConcurrentDictionary(std::size_t shardsCount = DefaultShardsCount, const LockSite& site = LockSite::Current())
+            :m_shardBits(0)
+        {
+            while((static_cast<std::size_t>(1) << m_shardBits) < shardsCount)
+                m_shardBits++;
+            m_shardsCount = static_cast<std::size_t>(1) << m_shardBits;
+            m_buffer.reset(new char[m_shardsCount * sizeof(Shard) + CacheLineSize]);
+            std::uintptr_t address = reinterpret_cast<std::uintptr_t>(m_buffer.get());
+            m_shards = reinterpret_cast<Shard*>((address + CacheLineSize - 1) & ~(static_cast<std::uintptr_t>(CacheLineSize) - 1));
+            for(std::size_t idx = 0; idx < m_shardsCount; idx++)
+                new(&m_shards[idx])Shard(site);
+        }
+        ConcurrentDictionary(const ConcurrentDictionary&) = delete;
+        ConcurrentDictionary& operator=(const ConcurrentDictionary&) = delete;
+        ~ConcurrentDictionary()
+        {
+            for(std::size_t idx = 0; idx < m_shardsCount; idx++)
+                m_shards[idx].~Shard();
+        }
         //AddValue receives a kay and a value, the function will determine if the recieved key already exists
         //with in the dictionary, if no it will copy the recieved value under the given key, if yes an exception
         //will be thrown (overwrite is not legit), all will be done in sync manner.
         void AddValue(const Key& key, const Value& value)
         {
-            std::unique_lock<std::mutex> localLock(m_mutex);
-            m_dictionary.find(key) == m_dictionary.end() ? m_dictionary[key] = value :
+            Shard& shard = GetShard(key);
+            ProfiledMutexLock localLock(shard.mutex);
+            shard.dictionary.emplace(key, value).second ? void() :
                 throw Exception(__CORE_SOURCE, "An existing key was provided");
         }
         //RemoveValue receives a key and attempts to remove the assosiate entry from the stored dictionary.
         void RemoveValue(const Key& key)
         {
-            std::unique_lock<std::mutex> localLock(m_mutex);
-            m_dictionary.erase(key);
+            Shard& shard = GetShard(key);
+            ProfiledMutexLock localLock(shard.mutex);
+            shard.dictionary.erase(key);
+        }
+        //AddValues adds the pairs whose keys don't exist yet, returning the number added, pairs are grouped by shard
+        //so each shard's lock is taken once. of pairs sharing a key, the first one wins.
+        std::size_t AddValues(const std::vector<std::pair<Key, Value>>& pairs)
+        {
+            std::size_t added = 0;
+            ForEachShardGroup(pairs.size(), [&pairs](std::size_t idx) -> const Key& { return pairs[idx].first; },
+                [&pairs, &added](Shard& shard, const std::size_t* indices, std::size_t count){
+                    for(std::size_t idx = 0; idx < count; idx++)
+                        added += shard.dictionary.emplace(pairs[indices[idx]].first, pairs[indices[idx]].second).second ? 1 : 0;
+                });
+            return added;
+        }
+        //RemoveValues removes the given keys, returning the number removed, each shard's lock is taken once.
+        std::size_t RemoveValues(const std::vector<Key>& keys)
+        {
+            std::size_t removed = 0;
+            ForEachShardGroup(keys.size(), [&keys](std::size_t idx) -> const Key& { return keys[idx]; },
+                [&keys, &removed](Shard& shard, const std::size_t* indices, std::size_t count){
+                    for(std::size_t idx = 0; idx < count; idx++)
+                        removed += shard.dictionary.erase(keys[indices[idx]]);
+                });
+            return removed;
         }
         //ContaisKey receives a key, the function will determine if the given key exists with in the dictioary, returning true or false accordinaly.
         bool ContainsKey(const Key& key) const
         {
-            std::unique_lock<std::mutex> localLock(m_mutex);
-            return m_dictionary.find(key) != m_dictionary.end();
+            Shard& shard = GetShard(key);
+            ProfiledMutexLock localLock(shard.mutex);
+            return shard.dictionary.find(key) != shard.dictionary.end();
         }
         //operator [] will try to return a specific value designated by a received key, if the value dosn't not exits
         //it will be added and returned, else - just returned.
-        Value& operator[](const Key& key) 
+        Value& operator[](const Key& key)
         {
-            std::unique_lock<std::mutex> localLock(m_mutex);
-            return m_dictionary[key];
+            Shard& shard = GetShard(key);
+            ProfiledMutexLock localLock(shard.mutex);
+            return shard.dictionary[key];
         }
-
+        //GetAllKeys locks a single shard at a time, keys added or removed meanwhile may or may not be reflected.
         std::vector<Key> GetAllKeys() const{
-            std::unique_lock<std::mutex> localLock(m_mutex);
             std::vector<Key> keys;
-            keys.reserve(m_dictionary.size());
-            for(auto const & pair : m_dictionary)
-                keys.push_back(pair.first);
+            for(std::size_t idx = 0; idx < m_shardsCount; idx++)
+            {
+                ProfiledMutexLock localLock(m_shards[idx].mutex);
+                keys.reserve(keys.size() + m_shards[idx].dictionary.size());
+                for(auto const & pair : m_shards[idx].dictionary)
+                    keys.push_back(pair.first);
+            }
             return keys;
         }
 
+        //Visit calls visitor(key, value) for every entry, shard by shard, each shard is copied under its lock and
+        //visited once the lock is released, so a long visit (i.e. an expiry scan) doesn't stall the shard's users.
+        //the entries of a shard are a consistent snapshot, changes to shards not visited yet may be reflected.
+        template<typename Visitor>
+        void Visit(const Visitor& visitor) const
+        {
+            std::vector<std::pair<Key, Value>> snapshot;
+            for(std::size_t idx = 0; idx < m_shardsCount; idx++)
+            {
+                {
+                    ProfiledMutexLock localLock(m_shards[idx].mutex);
+                    snapshot.assign(m_shards[idx].dictionary.begin(), m_shards[idx].dictionary.end());
+                }
+                for(auto const & pair : snapshot)
+                    visitor(pair.first, pair.second);
+            }
+        }
+
+        std::size_t GetShardsCount() const { return m_shardsCount; }
+
+    private:
+        static const std::size_t CacheLineSize = 64;
+
+        struct alignas(64) Shard
+        {
+            explicit Shard(const LockSite& site): mutex(site){}
+            mutable ProfiledMutex mutex;
+            std::unordered_map<Key, Value, Hash> dictionary;
+        };
+
+        //GetShardIndex picks the shard by the high bits of the (fibonacci mixed) hash, the shard's table uses the low ones.
+        std::size_t GetShardIndex(const Key& key) const
+        {
+            if(m_shardBits == 0)
+                return 0;
+            std::uint64_t hash = static_cast<std::uint64_t>(Hash()(key)) * 0x9E3779B97F4A7C15ULL;
+            return hash >> (64 - m_shardBits);
+        }
+
+        Shard& GetShard(const Key& key) const
+        {
+            return m_shards[GetShardIndex(key)];
+        }
+
+        //ForEachShardGroup orders the count items (keyed by keyOf) by their shard and calls func once per shard
+        //with the indices of its items, under the shard's lock. the items of a shard keep their relative order.
+        template<typename KeyOf, typename Func>
+        void ForEachShardGroup(std::size_t count, const KeyOf& keyOf, const Func& func)
+        {
+            std::vector<std::size_t> shardIndices(count);
+            for(std::size_t idx = 0; idx < count; idx++)
+                shardIndices[idx] = GetShardIndex(keyOf(idx));
+            std::vector<std::size_t> order(count);
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&shardIndices](std::size_t left, std::size_t right){
+                return shardIndices[left] < shardIndices[right];
+            });
+            for(std::size_t begin = 0, end = 0; begin < count; begin = end)
+            {
+                std::size_t shardIndex = shardIndices[order[begin]];
+                while(end < count && shardIndices[order[end]] == shardIndex)
+                    end++;
+                ProfiledMutexLock localLock(m_shards[shardIndex].mutex);
+                func(m_shards[shardIndex], &order[begin], end - begin);
+            }
+        }
 
     private:
-        std::map<Key, Value> m_dictionary;
-        mutable std::mutex m_mutex;
+        unsigned int m_shardBits;
+        std::size_t m_shardsCount;
+        std::unique_ptr<char[]> m_buffer;
+        Shard* m_shards;
     };
 }
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include "Exception.h"
+#include "LockProfiler.h"
+#include "Epoch.h"
+
+namespace core
+{
+    //ConcurrentHashMap is the read mostly sibling of ConcurrentDictionary, writers are serialized per shard by the shard's
+    //lock, while readers take no lock and write nothing shared, they traverse the shard's current table within an
+    //Epoch critical section. published nodes are immutable, an overwrite replaces the node, removed nodes and
+    //outgrown tables are retired to the Epoch and deleted once no reader may observe them.
+    //as a reader may run concurrently with a removal, values are never handed out by reference, Find copies the value
+    //out and Visit calls a visitor over it from within the critical section.
+    template <typename Key, typename Value, typename Hash = std::hash<Key>>
+    class ConcurrentHashMap
+    {
+    public:
+        static const std::size_t DefaultShardsCount = 16;
+
+        //shardsCount is rounded up to a power of 2.
+        explicit ConcurrentHashMap(std::size_t shardsCount = DefaultShardsCount, const LockSite& site = LockSite::Current())
+            :m_shardBits(0)
+        {
+            while((static_cast<std::size_t>(1) << m_shardBits) < shardsCount)
+                m_shardBits++;
+            m_shardsCount = static_cast<std::size_t>(1) << m_shardBits;
+            m_buffer.reset(new char[m_shardsCount * sizeof(Shard) + CacheLineSize]);
+            std::uintptr_t address = reinterpret_cast<std::uintptr_t>(m_buffer.get());
+            m_shards = reinterpret_cast<Shard*>((address + CacheLineSize - 1) & ~(static_cast<std::uintptr_t>(CacheLineSize) - 1));
+            for(std::size_t idx = 0; idx < m_shardsCount; idx++)
+                new(&m_shards[idx])Shard(site);
+        }
+        ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+        ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+        //No reader may be active by now, nodes are deleted right away.
+        ~ConcurrentHashMap()
+        {
+            for(std::size_t idx = 0; idx < m_shardsCount; idx++)
+                m_shards[idx].~Shard();
+        }
+        //AddValue throws if the key already exists.
+        void AddValue(const Key& key, const Value& value)
+        {
+            std::uint64_t hash = HashOf(key);
+            Shard& shard = GetShard(hash);
+            ProfiledMutexLock localLock(shard.mutex);
+            Table* table = shard.table.load(std::memory_order_relaxed);
+            if(Lookup(table, hash, key) != nullptr)
+                throw Exception(__CORE_SOURCE, "An existing key was provided");
+            Insert(shard, table, new Node(hash, key, value));
+        }
+        //SetValue adds the key or overwrites its value, readers observe either the old or the new value.
+        void SetValue(const Key& key, const Value& value)
+        {
+            std::uint64_t hash = HashOf(key);
+            Shard& shard = GetShard(hash);
+            ProfiledMutexLock localLock(shard.mutex);
+            Table* table = shard.table.load(std::memory_order_relaxed);
+            std::atomic<Node*>* link = FindLink(table, hash, key);
+            if(link == nullptr)
+            {
+                Insert(shard, table, new Node(hash, key, value));
+                return;
+            }
+            Node* previous = link->load(std::memory_order_relaxed);
+            Node* node = new Node(hash, key, value);
+            node->next.store(previous->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            link->store(node, std::memory_order_release);
+            Epoch::Retire(previous);
+        }
+        //RemoveValue returns false if the key doesn't exist.
+        bool RemoveValue(const Key& key)
+        {
+            std::uint64_t hash = HashOf(key);
+            Shard& shard = GetShard(hash);
+            ProfiledMutexLock localLock(shard.mutex);
+            std::atomic<Node*>* link = FindLink(shard.table.load(std::memory_order_relaxed), hash, key);
+            if(link == nullptr)
+                return false;
+            Node* node = link->load(std::memory_order_relaxed);
+            link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+            shard.count--;
+            Epoch::Retire(node);
+            return true;
+        }
+
+        bool ContainsKey(const Key& key) const
+        {
+            return Visit(key, [](const Value&){});
+        }
+        //Find copies the key's value into value, returns false if the key doesn't exist.
+        bool Find(const Key& key, Value& value) const
+        {
+            return Visit(key, [&value](const Value& current){ value = current; });
+        }
+        //Visit calls visitor with the key's value, the value is valid for the duration of the call only, visitor
+        //should be short as retired nodes are held back meanwhile. returns false if the key doesn't exist.
+        template<typename Visitor>
+        bool Visit(const Key& key, const Visitor& visitor) const
+        {
+            std::uint64_t hash = HashOf(key);
+            const Shard& shard = GetShard(hash);
+            Epoch::Guard guard;
+            const Node* node = Lookup(shard.table.load(std::memory_order_acquire), hash, key);
+            if(node == nullptr)
+                return false;
+            visitor(static_cast<const Value&>(node->value));
+            return true;
+        }
+
+        std::size_t GetShardsCount() const { return m_shardsCount; }
+
+    private:
+        static const std::size_t CacheLineSize = 64;
+        static const std::size_t InitialBucketsCount = 16;
+
+        struct Node
+        {
+            Node(std::uint64_t hash, const Key& key, const Value& value): next(nullptr), hash(hash), key(key), value(value){}
+            std::atomic<Node*> next;
+            const std::uint64_t hash;
+            const Key key;
+            const Value value;
+        };
+
+        struct Table
+        {
+            explicit Table(std::size_t bucketsCount): mask(bucketsCount - 1), buckets(new std::atomic<Node*>[bucketsCount])
+            {
+                for(std::size_t idx = 0; idx < bucketsCount; idx++)
+                    buckets[idx].store(nullptr, std::memory_order_relaxed);
+            }
+            std::atomic<Node*>& Bucket(std::uint64_t hash) { return buckets[hash & mask]; }
+            const std::size_t mask;
+            std::unique_ptr<std::atomic<Node*>[]> buckets;
+        };
+
+        struct alignas(64) Shard
+        {
+            explicit Shard(const LockSite& site): mutex(site), table(new Table(InitialBucketsCount)), count(0){}
+            ~Shard()
+            {
+                Table* current = table.load(std::memory_order_relaxed);
+                for(std::size_t idx = 0; idx <= current->mask; idx++)
+                    DeleteChain(current->buckets[idx].load(std::memory_order_relaxed));
+                delete current;
+            }
+            mutable ProfiledMutex mutex;
+            std::atomic<Table*> table;
+            std::size_t count; //Guarded by mutex
+        };
+
+        static void DeleteChain(Node* node)
+        {
+            while(node)
+            {
+                Node* next = node->next.load(std::memory_order_relaxed);
+                delete node;
+                node = next;
+            }
+        }
+
+        static const Node* Lookup(Table* table, std::uint64_t hash, const Key& key)
+        {
+            for(Node* node = table->Bucket(hash).load(std::memory_order_acquire); node;
+                node = node->next.load(std::memory_order_acquire))
+                if(node->hash == hash && node->key == key)
+                    return node;
+            return nullptr;
+        }
+
+        //FindLink returns the link pointing at the key's node, or nullptr, must be called under the shard's lock.
+        static std::atomic<Node*>* FindLink(Table* table, std::uint64_t hash, const Key& key)
+        {
+            for(std::atomic<Node*>* link = &table->Bucket(hash); ; )
+            {
+                Node* node = link->load(std::memory_order_relaxed);
+                if(node == nullptr)
+                    return nullptr;
+                if(node->hash == hash && node->key == key)
+                    return link;
+                link = &node->next;
+            }
+        }
+
+        //Insert links node at its bucket's head, growing the table once the load factor exceeds 1, must be
+        //called under the shard's lock.
+        static void Insert(Shard& shard, Table* table, Node* node)
+        {
+            std::atomic<Node*>& bucket = table->Bucket(node->hash);
+            node->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            bucket.store(node, std::memory_order_release);
+            if(++shard.count > table->mask + 1)
+                Grow(shard, table);
+        }
+
+        //Grow copies the nodes into a table twice as large, as readers may still be traversing the current
+        //chains they are left intact, the current table and its nodes are retired once the new one is published.
+        static void Grow(Shard& shard, Table* table)
+        {
+            std::unique_ptr<Table> grown(new Table((table->mask + 1) * 2));
+            for(std::size_t idx = 0; idx <= table->mask; idx++)
+                for(Node* node = table->buckets[idx].load(std::memory_order_relaxed); node;
+                    node = node->next.load(std::memory_order_relaxed))
+                {
+                    Node* copy = new Node(node->hash, node->key, node->value);
+                    std::atomic<Node*>& bucket = grown->Bucket(copy->hash);
+                    copy->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                    bucket.store(copy, std::memory_order_relaxed);
+                }
+            shard.table.store(grown.release(), std::memory_order_release);
+            for(std::size_t idx = 0; idx <= table->mask; idx++)
+                for(Node* node = table->buckets[idx].load(std::memory_order_relaxed); node; )
+                {
+                    Node* next = node->next.load(std::memory_order_relaxed);
+                    Epoch::Retire(node);
+                    node = next;
+                }
+            Epoch::Retire(table);
+        }
+
+        static std::uint64_t HashOf(const Key& key)
+        {
+            return static_cast<std::uint64_t>(Hash()(key)) * 0x9E3779B97F4A7C15ULL;
+        }
+
+        //GetShard picks the shard by the high bits of the (fibonacci mixed) hash, the shard's table uses the low ones.
+        Shard& GetShard(std::uint64_t hash) const
+        {
+            if(m_shardBits == 0)
+                return m_shards[0];
+            return m_shards[hash >> (64 - m_shardBits)];
+        }
+
+    private:
+        unsigned int m_shardBits;
+        std::size_t m_shardsCount;
+        std::unique_ptr<char[]> m_buffer;
+        Shard* m_shards;
+    };
+}
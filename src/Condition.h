@@ -3,86 +3,99 @@
 #include <atomic>
 #include <mutex>
 #include <limits>
-#if defined(__linux)
-#include <unistd.h>
-#include <linux/futex.h>
-#include <sys/syscall.h>
-#endif
+#include <chrono>
+#include <cstddef>
+#include <condition_variable>
+#include "Futex.h"
 #include "Mutex.h"
 
 namespace core{
     
+    //Condition is a sequence counter based condition, waiters sleep on the sequence and a signal advances it, so the
+    //signaller never waits for the waiters, and the syscall is skipped altogether when no one waits.
+    //NOTIFY_ALL wakes a single waiter and requeues the rest onto the mutex word, they are released one by one as the
+    //mutex is handed over instead of storming it. all state resides within the object, the mutex is located relatively
+    //to the condition, so when shared between processes both must be placed within the same mapping. the condition and
+    //its mutex must be constructed with the same futex scope.
     class Condition
     {
     public:
         enum Command : int
         {
-            SLEEP = 0,
-            NOTIFY_ONE,
+            NOTIFY_ONE = 1,
             NOTIFY_ALL
         };
     
-        Condition(): m_command(SLEEP), m_waitersCount(0){}
+        explicit Condition(Futex::Scope scope = Futex::Scope::SHARED): m_sequence(0), m_waitersCount(0), m_mutexOffset(0), m_scope(scope){}
         Condition(const Condition&) = delete;
         Condition& operator=(const Condition&) = delete;
         
         void signal(Command command)
         {
-            m_wakeLock.lock();
-            if(m_waitersCount == 0)
+            if(m_waitersCount.load() == 0)
+                return;
+            int sequence = m_sequence.fetch_add(1) + 1;
+            if(command == NOTIFY_ONE)
             {
-                m_wakeLock.unlock();
+                Futex::Wake(SequenceWord(), 1, m_scope);
                 return;
             }
-            m_command.store(command);
-#if defined(__linux)
-            syscall(SYS_futex, &m_command, FUTEX_WAKE, command == NOTIFY_ONE ? 1 : std::numeric_limits<int>::max(), nullptr, nullptr, 0);
-#else
-            throw Exception(__CORE_SOURCE, "wake is not being supported by current platform");
-#endif
-    
-            while(m_command.load() != SLEEP && m_waitersCount.load() != 0){}
-    
-            m_wakeLock.unlock();
+            
+            Mutex* mutex = reinterpret_cast<Mutex*>(reinterpret_cast<char*>(this) + m_mutexOffset.load(std::memory_order_relaxed));
+            while(Futex::CmpRequeue(SequenceWord(), sequence, 1, &mutex->m_word, std::numeric_limits<int>::max(), m_scope) == false)
+                sequence = m_sequence.load();
         }
         
         void wait(std::unique_lock<Mutex>& mutex)
         {
-            m_waitersCount++;
-            mutex.unlock();
-            while (true) {
-                while (m_command.load() == SLEEP)
-#if defined(__linux)
-                    syscall(SYS_futex, &m_command, FUTEX_WAIT, SLEEP, nullptr, nullptr, 0);
-#else
-                throw Exception(__CORE_SOURCE, "wait is not being supported by current platform");
-#endif
+            Wait(mutex, [this](int sequence){ return Futex::Wait(SequenceWord(), sequence, m_scope); });
+        }
+        
+        template<typename Clock, typename Duration>
+        std::cv_status wait_until(std::unique_lock<Mutex>& mutex, const std::chrono::time_point<Clock, Duration>& atime)
+        {
+            return Wait(mutex, [this, &atime](int sequence){ return Futex::WaitUntil(SequenceWord(), sequence, atime, m_scope); }) ?
+                   std::cv_status::no_timeout : std::cv_status::timeout;
+        }
+        
+        template<typename Rep, typename Period>
+        std::cv_status wait_for(std::unique_lock<Mutex>& mutex, const std::chrono::duration<Rep, Period>& rtime)
+        {
+            return wait_until(mutex, std::chrono::steady_clock::now() + rtime);
+        }
+    
+    private:
+        void* SequenceWord(){ return &m_sequence; }
         
-                int fromCommand_one = NOTIFY_ONE;
-                if (m_command.compare_exchange_strong(fromCommand_one, static_cast<int>(SLEEP))) {
-                    m_waitersCount--;
-                    mutex.lock();
-                    return;
-                } else if (m_command.load() == NOTIFY_ALL) {
-                    if (m_waitersCount.fetch_sub(1) == 1)
-                        m_command.store(SLEEP);
+        //Wait returns false if sleep has timed out while the sequence remained unchanged. the mutex is reacquired as
+        //contended, since the waiter may have been requeued onto it.
+        template<typename Sleep>
+        bool Wait(std::unique_lock<Mutex>& lock, const Sleep& sleep)
+        {
+            Mutex* mutex = lock.release();
+            m_mutexOffset.store(reinterpret_cast<char*>(mutex) - reinterpret_cast<char*>(this), std::memory_order_relaxed);
+            m_waitersCount++;
+            int sequence = m_sequence.load();
+            mutex->unlock();
             
-                    mutex.lock();
-                    return;
-                }
-            }
+            bool signaled = sleep(sequence) || m_sequence.load() != sequence;
+            m_waitersCount--;
+            mutex->LockContended();
+            lock = std::unique_lock<Mutex>(*mutex, std::adopt_lock);
+            return signaled;
         }
     
     private:
-        volatile std::atomic<int> m_command;
+        std::atomic<int> m_sequence;
         std::atomic<int> m_waitersCount;
-        Mutex m_wakeLock;
+        std::atomic<std::ptrdiff_t> m_mutexOffset; //Mutex location relative to the condition, set by the waiters
+        const Futex::Scope m_scope;
     };
     
     class ConditionVariable
     {
     public:
-        ConditionVariable()=default;
+        explicit ConditionVariable(Futex::Scope scope = Futex::Scope::SHARED): m_condition(scope){}
         ConditionVariable(const ConditionVariable&) = delete;
         ConditionVariable& operator=(const ConditionVariable&) = delete;
         
@@ -94,6 +107,36 @@ namespace core{
         }
     
         void wait(std::unique_lock<core::Mutex> &mutex){ m_condition.wait(mutex); }
+        
+        template<typename Clock, typename Duration>
+        std::cv_status wait_until(std::unique_lock<Mutex>& lock, const std::chrono::time_point<Clock, Duration>& atime)
+        {
+            return m_condition.wait_until(lock, atime);
+        }
+        
+        //Returns the predicate value upon return, false means the deadline has expired while the predicate is false.
+        template<typename Clock, typename Duration, typename Predict>
+        bool wait_until(std::unique_lock<Mutex>& lock, const std::chrono::time_point<Clock, Duration>& atime, const Predict& predict)
+        {
+            while(predict() == false)
+            {
+                if(m_condition.wait_until(lock, atime) == std::cv_status::timeout)
+                    return predict();
+            }
+            return true;
+        }
+        
+        template<typename Rep, typename Period>
+        std::cv_status wait_for(std::unique_lock<Mutex>& lock, const std::chrono::duration<Rep, Period>& rtime)
+        {
+            return wait_until(lock, std::chrono::steady_clock::now() + rtime);
+        }
+        
+        template<typename Rep, typename Period, typename Predict>
+        bool wait_for(std::unique_lock<Mutex>& lock, const std::chrono::duration<Rep, Period>& rtime, const Predict& predict)
+        {
+            return wait_until(lock, std::chrono::steady_clock::now() + rtime, predict);
+        }
         void notify_one(){ m_condition.signal(Condition::NOTIFY_ONE); }
         void notify_all(){ m_condition.signal(Condition::NOTIFY_ALL); }
         
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace core{
+
+    //CpuRelax hints the cpu that the caller is busy waiting, releasing pipeline resources to the sibling hyper thread.
+    inline void CpuRelax()
+    {
+    #if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+    #elif defined(__aarch64__)
+        asm volatile("yield" ::: "memory");
+    #endif
+    }
+
+    //CpuCycles returns a cheap, monotonic within a core, time stamp, suitable for short interval estimations only.
+    inline std::uint64_t CpuCycles()
+    {
+    #if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+    #else
+        return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    #endif
+    }
+}
@@ -1,24 +1,274 @@
 #include "DefaultLogger.h"
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#if defined(__linux)
+#include <unistd.h>
+#include <pthread.h>
+#endif
 #include "Exception.h"
+#include "Assert.h"
+#include "Logger.h"
+
+using namespace std;
 
 namespace core
 {
-    DefaultLogger::~DefaultLogger() {}
+    namespace
+    {
+        //The running loggers, their writers are restarted within a forked child (a fork duplicates the calling thread only).
+        mutex loggersMutex;
+        vector<DefaultLogger*> loggers;
+        once_flag atForkFlag;
+    }
+
+    DefaultLogger::DefaultLogger(int descriptor, OverflowPolicy policy, size_t cellsCount)
+        :m_ring(cellsCount), m_descriptor(descriptor), m_policy(policy), m_severity(TraceSeverity::NoneWorking),
+         m_running(false), m_dropped(0), m_writtenEvent(0), m_flushers(0), m_written(0), m_pauseRequested(0), m_formatting(0),
+         m_second(-1)
+    {
+        m_batch.reserve(BatchSize + LogRing::CellDataSize);
+    }
+
+    DefaultLogger::~DefaultLogger()
+    {
+        if(m_running.exchange(false) == false)
+            return;
+        {
+            lock_guard<mutex> lock(loggersMutex);
+            loggers.erase(remove(loggers.begin(), loggers.end(), this), loggers.end());
+        }
+        m_ring.WakeConsumer();
+        m_writer.join(); //The writer drains the ring before exiting
+    }
 
     void DefaultLogger::Start(TraceSeverity severity) {
-        m_listener.SetSeverity(severity);
+        m_severity.store(severity, memory_order_relaxed);
+        if(m_running.exchange(true))
+            return;
+    #if defined(__linux)
+        call_once(atForkFlag, []{
+            PLATFORM_VERIFY(pthread_atfork(&DefaultLogger::PrepareFork, &DefaultLogger::ParentAfterFork, &DefaultLogger::ChildAfterFork) == 0);
+        });
+    #endif
+        lock_guard<mutex> lock(loggersMutex);
+        loggers.push_back(this);
+        StartWriter();
     }
 
     void DefaultLogger::Log(TraceSeverity severity, const std::string &msg) {
-        m_listener.Log(severity, msg);
+        if(severity < m_severity.load(memory_order_relaxed))
+            return;
+        int64_t timestamp = chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
+        Push(severity, reinterpret_cast<const char*>(&timestamp), sizeof(timestamp), msg.data(), msg.size());
+    }
+
+    void DefaultLogger::LogDeferred(TraceSeverity severity, const char* record, size_t size) {
+        if(severity < m_severity.load(memory_order_relaxed))
+            return;
+        if(size > m_ring.GetMaxRecordSize()) //Can't be truncated as is
+        {
+            LoggerImpl::LogDeferred(severity, record, size);
+            return;
+        }
+        Push(severity | DeferredTag, nullptr, 0, record, size);
+    }
+
+    void DefaultLogger::Push(uint32_t tag, const char* header, size_t headerSize, const char* data, size_t size)
+    {
+        size = min(size, m_ring.GetMaxRecordSize() - headerSize);
+        if(m_policy == OverflowPolicy::BLOCK)
+            m_ring.Push(tag, header, headerSize, data, size);
+        else if(m_ring.TryPush(tag, header, headerSize, data, size) == false)
+            m_dropped.fetch_add(1, memory_order_relaxed);
     }
 
     void DefaultLogger::Flush() {
-        m_listener.Flush();
+        uint64_t target = m_ring.GetTail();
+        if(m_running.load() == false)
+            return;
+        m_flushers.fetch_add(1, memory_order_seq_cst);
+        while(m_written.load(memory_order_acquire) < target)
+        {
+            int event = m_writtenEvent.load(memory_order_seq_cst);
+            if(m_written.load(memory_order_acquire) >= target)
+                break;
+            m_ring.WakeConsumer();
+            struct timespec timeout = Futex::ToTimespec(chrono::milliseconds(10)); //The writer may be asleep by the wake
+            Futex::Wait(&m_writtenEvent, event, Futex::Scope::PRIVATE, &timeout);
+        }
+        m_flushers.fetch_sub(1, memory_order_relaxed);
     }
 
     void DefaultLogger::AddListener(const std::shared_ptr<TraceListener> &listener) {
         throw Exception(__CORE_SOURCE, "Adding listeners to default logger is not possible.");
     }
-}
 
+    void DefaultLogger::StartWriter()
+    {
+        m_writer = thread(&DefaultLogger::WriterLoop, this);
+    }
+
+    void DefaultLogger::WriterLoop()
+    {
+        const struct timespec idleTimeout = Futex::ToTimespec(chrono::milliseconds(100));
+        while(true)
+        {
+            if(BeginFormatting() == false)
+                continue;
+            //A bounded batch, the ring's room is handed back to blocked producers and flushers learn of the progress
+            //even while the ring never drains
+            size_t consumed = m_ring.Consume([this](uint32_t tag, const char* data, size_t size){
+                AppendRecord(tag, data, size);
+            }, ConsumeBatchCount);
+            EndFormatting();
+            if(m_batch.empty() == false)
+            {
+                Write(m_batch.data(), m_batch.size());
+                m_batch.clear();
+            }
+            if(consumed != 0)
+            {
+                m_written.store(m_ring.GetConsumed(), memory_order_release);
+                m_writtenEvent.fetch_add(1, memory_order_seq_cst);
+                if(m_flushers.load(memory_order_seq_cst) != 0)
+                    Futex::Wake(&m_writtenEvent, numeric_limits<int>::max(), Futex::Scope::PRIVATE);
+                continue;
+            }
+            if(m_running.load() == false)
+                break;
+            m_ring.WaitForRecords(idleTimeout);
+        }
+    }
+
+    void DefaultLogger::AppendRecord(uint32_t tag, const char* data, size_t size)
+    {
+        int64_t timestamp;
+        if(tag & DeferredTag)
+        {
+            memcpy(&timestamp, data + offsetof(DeferredRecordHeader, timestamp), sizeof(timestamp));
+            AppendTimestamp(timestamp);
+            FormatDeferredRecord(data, m_message);
+            m_batch.append(m_message);
+        }
+        else
+        {
+            memcpy(&timestamp, data, sizeof(timestamp));
+            AppendTimestamp(timestamp);
+            m_batch.append(data + sizeof(timestamp), size - sizeof(timestamp));
+        }
+        m_batch.push_back('\n');
+    }
+
+    //AppendTimestamp appends the local time as YYYY-MM-DD HH:MM:SS.uuuuuu, the calendar part is rendered once a second.
+    void DefaultLogger::AppendTimestamp(int64_t timestamp)
+    {
+        int64_t second = timestamp / 1000000000;
+        if(second != m_second)
+        {
+            time_t time = static_cast<time_t>(second);
+            struct tm calendar;
+            localtime_r(&time, &calendar);
+            strftime(m_secondText, sizeof(m_secondText), "%Y-%m-%d %H:%M:%S", &calendar);
+            m_second = second;
+        }
+        char fraction[16];
+        int size = snprintf(fraction, sizeof(fraction), ".%06d\t", static_cast<int>(timestamp % 1000000000 / 1000));
+        m_batch.append(m_secondText);
+        m_batch.append(fraction, size);
+    }
+
+    void DefaultLogger::Write(const char* data, size_t size)
+    {
+    #if defined(__linux)
+        while(size != 0)
+        {
+            ssize_t written = ::write(m_descriptor, data, size);
+            if(written == -1)
+            {
+                if(errno == EINTR)
+                    continue;
+                return; //Nowhere to report to
+            }
+            data += written;
+            size -= written;
+        }
+    #endif
+    }
+
+    //BeginFormatting marks the writer as mutating its buffers (appending, or within localtime_r's lock), unless a fork
+    //is pending, in which case the writer parks until it's done and false is returned.
+    bool DefaultLogger::BeginFormatting()
+    {
+        m_formatting.store(1, memory_order_seq_cst);
+        if(m_pauseRequested.load(memory_order_seq_cst) == 0)
+            return true;
+        EndFormatting();
+        while(m_pauseRequested.load(memory_order_seq_cst) != 0)
+            Futex::Wait(&m_pauseRequested, 1, Futex::Scope::PRIVATE);
+        return false;
+    }
+
+    void DefaultLogger::EndFormatting()
+    {
+        m_formatting.store(0, memory_order_seq_cst);
+        if(m_pauseRequested.load(memory_order_seq_cst) != 0)
+            Futex::Wake(&m_formatting, 1, Futex::Scope::PRIVATE);
+    }
+
+    //PauseWriter returns once the writer is outside of its formatting, a write to the descriptor may still be in
+    //progress, it leaves the buffers intact.
+    void DefaultLogger::PauseWriter()
+    {
+        m_pauseRequested.store(1, memory_order_seq_cst);
+        while(m_formatting.load(memory_order_seq_cst) != 0)
+            Futex::Wait(&m_formatting, 1, Futex::Scope::PRIVATE);
+    }
+
+    void DefaultLogger::ResumeWriter()
+    {
+        m_pauseRequested.store(0, memory_order_seq_cst);
+        Futex::Wake(&m_pauseRequested, numeric_limits<int>::max(), Futex::Scope::PRIVATE);
+    }
+
+    //PrepareFork brings the writers to a safe point, so the child inherits consistent buffers and no lock held by them.
+    void DefaultLogger::PrepareFork()
+    {
+        loggersMutex.lock();
+        for(DefaultLogger* logger : loggers)
+            logger->PauseWriter();
+    }
+
+    void DefaultLogger::ParentAfterFork()
+    {
+        for(DefaultLogger* logger : loggers)
+            logger->ResumeWriter();
+        loggersMutex.unlock();
+    }
+
+    //ChildAfterFork drops the parent's pending messages, and starts a writer for the child, the parent's writer handle
+    //refers to a thread which doesn't exist within the child, it can be neither joined nor detached, so it is leaked.
+    void DefaultLogger::ChildAfterFork()
+    {
+        for(DefaultLogger* logger : loggers)
+        {
+            new thread(move(logger->m_writer));
+            logger->m_ring.Reset();
+            logger->m_batch.clear();
+            logger->m_message.clear();
+            logger->m_flushers.store(0, memory_order_relaxed);
+            logger->m_written.store(0, memory_order_relaxed);
+            logger->m_pauseRequested.store(0, memory_order_relaxed);
+            logger->m_formatting.store(0, memory_order_relaxed);
+            logger->StartWriter();
+        }
+        loggersMutex.unlock();
+    }
+}
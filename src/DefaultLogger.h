@@ -1,21 +1,76 @@
 #pragma once
 
+#include <atomic>
+#include <thread>
+#include <string>
+#include <cstdint>
 #include "LoggerImpl.h"
-#include "DefaultTraceListeners.h"
+#include "LogRing.h"
 
 namespace core
 {
+    //DefaultLogger is an asynchronous logger, Log pushes the message into a lock free ring, a dedicated writer thread
+    //drains the ring and batches the messages into large writes to the descriptor (stdout by default).
+    //once the ring is full, Log either blocks until the writer frees room or drops the message, counting it.
+    //deferred records (see DeferredRecord) are pushed as is and formatted by the writer. each line is prefixed by the
+    //time it was logged at.
     class DefaultLogger: public LoggerImpl
     {
     public:
+        enum class OverflowPolicy
+        {
+            BLOCK,
+            DROP
+        };
+
+        static const std::size_t DefaultCellsCount = 8192; //Of LogRing::CellDataSize bytes each
+
+        explicit DefaultLogger(int descriptor = 1, OverflowPolicy policy = OverflowPolicy::BLOCK,
+            std::size_t cellsCount = DefaultCellsCount);
         virtual ~DefaultLogger();
         void Start(TraceSeverity severity) override;
         void Log(TraceSeverity severity, const std::string& msg) override;
+        void LogDeferred(TraceSeverity severity, const char* record, std::size_t size) override;
+        bool SupportsDeferredFormatting() const override { return true; }
+        //Flush returns once every message logged before the call was written.
         void Flush() override;
         void AddListener(const std::shared_ptr<TraceListener>& listener) override;
+        std::uint64_t GetDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
 
     private:
-        StdOutListener m_listener;
+        void Push(std::uint32_t tag, const char* header, std::size_t headerSize, const char* data, std::size_t size);
+        void WriterLoop();
+        void AppendRecord(std::uint32_t tag, const char* data, std::size_t size);
+        void AppendTimestamp(std::int64_t timestamp);
+        void Write(const char* data, std::size_t size);
+        void StartWriter();
+        bool BeginFormatting();
+        void EndFormatting();
+        void PauseWriter();
+        void ResumeWriter();
+        static void PrepareFork();
+        static void ParentAfterFork();
+        static void ChildAfterFork();
+
+    private:
+        static const std::size_t BatchSize = 64 * 1024;
+        static const std::size_t ConsumeBatchCount = 1024; //Records consumed between progress notifications
+        static const std::uint32_t DeferredTag = 1 << 16; //Tags carry the severity within their low bits
+        LogRing m_ring;
+        const int m_descriptor;
+        const OverflowPolicy m_policy;
+        std::atomic<short> m_severity;
+        std::atomic<bool> m_running;
+        std::atomic<std::uint64_t> m_dropped;
+        std::atomic<int> m_writtenEvent; //Bumped by the writer after each batch, flushers wait on it
+        std::atomic<int> m_flushers;
+        std::atomic<std::uint64_t> m_written; //Ring position up to which the records were written
+        std::atomic<int> m_pauseRequested; //Set by a forking thread, the writer parks before formatting
+        std::atomic<int> m_formatting; //Set while the writer mutates its buffers
+        std::string m_batch;
+        std::string m_message; //The writer's formatting buffer
+        std::int64_t m_second; //The second m_secondText renders
+        char m_secondText[32];
+        std::thread m_writer;
     };
 }
-
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <string>
+#include <tuple>
+#include <utility>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include "Source.h"
+
+namespace core
+{
+    //DeferredRecord is the binary form of a trace, the call site only copies the format pointer, the source, a time
+    //stamp and the raw argument values (c strings by content, as they may not outlive the call), the formatting is
+    //left to whoever consumes the record, through the formatter captured within its header, the one instantiation
+    //which knows the arguments' types (nanolog's split). the format and the source's strings must be literals.
+    struct DeferredRecordHeader
+    {
+        typedef void(*Formatter)(const DeferredRecordHeader& header, const char* arguments, std::string& message);
+
+        Formatter formatter;
+        Source source;
+        const char* format;
+        std::int64_t timestamp; //System clock nanoseconds
+    };
+
+    //FormatDeferred formats a decoded record as Logger::BuildMessage does.
+    std::string FormatDeferred(const Source& source, const char* format, ...);
+
+    //DeferredArgument encodes a single argument, scalars are copied as is.
+    template<typename Type>
+    struct DeferredArgument
+    {
+        static_assert(std::is_trivially_copyable<Type>::value, "Only trivially copyable arguments may be deferred");
+        static_assert(std::is_array<Type>::value == false, "Arrays are deferred decayed, as passed through varargs");
+        typedef Type Decoded;
+
+        static std::size_t Size(const Type&){ return sizeof(Type); }
+
+        static char* Encode(char* cursor, const Type& value)
+        {
+            std::memcpy(cursor, &value, sizeof(Type));
+            return cursor + sizeof(Type);
+        }
+
+        static Type Decode(const char*& cursor)
+        {
+            Type value;
+            std::memcpy(&value, cursor, sizeof(Type));
+            cursor += sizeof(Type);
+            return value;
+        }
+    };
+
+    //c strings, of any char flavour, are copied with their terminator, prefixed by their length (a null is kept as such).
+    template<typename Char>
+    struct DeferredCString
+    {
+        typedef const Char* Decoded;
+        static const std::uint32_t Null = std::numeric_limits<std::uint32_t>::max();
+
+        static std::size_t Size(const Char* value){ return sizeof(std::uint32_t) + (value ? Length(value) + 1 : 0); }
+
+        static char* Encode(char* cursor, const Char* value)
+        {
+            std::uint32_t length = value ? static_cast<std::uint32_t>(Length(value)) : Null;
+            std::memcpy(cursor, &length, sizeof(length));
+            cursor += sizeof(length);
+            if(value == nullptr)
+                return cursor;
+            std::memcpy(cursor, value, length + 1);
+            return cursor + length + 1;
+        }
+
+        static const Char* Decode(const char*& cursor)
+        {
+            std::uint32_t length;
+            std::memcpy(&length, cursor, sizeof(length));
+            cursor += sizeof(length);
+            if(length == Null)
+                return nullptr;
+            const Char* value = reinterpret_cast<const Char*>(cursor);
+            cursor += length + 1;
+            return value;
+        }
+
+    private:
+        static std::size_t Length(const Char* value){ return std::strlen(reinterpret_cast<const char*>(value)); }
+    };
+
+    template<> struct DeferredArgument<const char*>: DeferredCString<char>{};
+    template<> struct DeferredArgument<char*>: DeferredCString<char>{};
+    template<> struct DeferredArgument<const signed char*>: DeferredCString<signed char>{};
+    template<> struct DeferredArgument<signed char*>: DeferredCString<signed char>{};
+    template<> struct DeferredArgument<const unsigned char*>: DeferredCString<unsigned char>{};
+    template<> struct DeferredArgument<unsigned char*>: DeferredCString<unsigned char>{};
+
+    template<typename... Args>
+    class DeferredRecord
+    {
+    public:
+        static std::size_t Size(const Args&... args)
+        {
+            std::size_t size = sizeof(DeferredRecordHeader);
+            int expand[] = {0, (size += DeferredArgument<Args>::Size(args), 0)...};
+            (void)expand;
+            return size;
+        }
+
+        //Encode writes the record into buffer, which must hold Size(args...) bytes.
+        static void Encode(char* buffer, const Source& source, const char* format, std::int64_t timestamp, const Args&... args)
+        {
+            DeferredRecordHeader header{&DeferredRecord::Format, source, format, timestamp};
+            std::memcpy(buffer, &header, sizeof(header));
+            char* cursor = buffer + sizeof(header);
+            int expand[] = {0, (cursor = DeferredArgument<Args>::Encode(cursor, args), 0)...};
+            (void)expand;
+            (void)cursor;
+        }
+
+    private:
+        static void Format(const DeferredRecordHeader& header, const char* arguments, std::string& message)
+        {
+            Format(header, arguments, message, std::index_sequence_for<Args...>());
+        }
+
+        template<std::size_t... Indices>
+        static void Format(const DeferredRecordHeader& header, const char* arguments, std::string& message, std::index_sequence<Indices...>)
+        {
+            const char* cursor = arguments;
+            (void)cursor;
+            //A braced initialization evaluates its elements in order
+            std::tuple<typename DeferredArgument<Args>::Decoded...> values{DeferredArgument<Args>::Decode(cursor)...};
+            (void)values;
+            message = FormatDeferred(header.source, header.format, std::get<Indices>(values)...);
+        }
+    };
+
+    //FormatDeferredRecord decodes and formats a record, as produced by DeferredRecord::Encode.
+    inline void FormatDeferredRecord(const char* record, std::string& message)
+    {
+        DeferredRecordHeader header;
+        std::memcpy(&header, record, sizeof(header));
+        header.formatter(header, record + sizeof(header), message);
+    }
+}
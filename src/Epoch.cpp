@@ -0,0 +1,159 @@
+#include "Epoch.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+
+using namespace std;
+
+namespace core
+{
+    namespace
+    {
+        const size_t CollectInterval = 64; //Retirements between collection attempts
+        const size_t CacheLineSize = 64;
+
+        struct RetiredObject
+        {
+            void* object;
+            Epoch::Deleter deleter;
+            uint64_t epoch;
+        };
+
+        //ThreadRecord is owned by a single thread at a time, records are never freed, a record released by an
+        //exiting thread is reused by the next one. records are padded on both ends (new doesn't honour an extended
+        //alignment), the owner's writes never share a line with another thread's record.
+        struct ThreadRecord
+        {
+            char leadingPadding[CacheLineSize];
+            atomic<uint64_t> epoch; //0 while outside of a critical section
+            atomic<bool> inUse;
+            ThreadRecord* next;
+            int nesting;
+            vector<RetiredObject> retired;
+            char trailingPadding[CacheLineSize];
+        };
+
+        atomic<uint64_t> globalEpoch(1);
+        atomic<ThreadRecord*> records(nullptr);
+        mutex orphansMutex;
+        vector<RetiredObject> orphans; //Retired by threads which exited before their objects became safe to delete
+
+        bool TryAdvance()
+        {
+            uint64_t epoch = globalEpoch.load(memory_order_seq_cst);
+            for(ThreadRecord* record = records.load(memory_order_acquire); record; record = record->next)
+            {
+                uint64_t recordEpoch = record->epoch.load(memory_order_seq_cst);
+                if(recordEpoch != 0 && recordEpoch != epoch)
+                    return false;
+            }
+            return globalEpoch.compare_exchange_strong(epoch, epoch + 1, memory_order_seq_cst);
+        }
+
+        void DeleteSafe(vector<RetiredObject>& retired)
+        {
+            uint64_t epoch = globalEpoch.load(memory_order_seq_cst);
+            auto safeEnd = partition(retired.begin(), retired.end(), [epoch](const RetiredObject& retiredObject){
+                return retiredObject.epoch + 2 <= epoch;
+            });
+            for(auto it = retired.begin(); it != safeEnd; ++it)
+                it->deleter(it->object);
+            retired.erase(retired.begin(), safeEnd);
+        }
+
+        void CollectOrphans()
+        {
+            unique_lock<mutex> lock(orphansMutex, try_to_lock);
+            if(lock.owns_lock() && orphans.empty() == false)
+                DeleteSafe(orphans);
+        }
+
+        ThreadRecord* AcquireRecord()
+        {
+            for(ThreadRecord* record = records.load(memory_order_acquire); record; record = record->next)
+            {
+                bool inUse = false;
+                if(record->inUse.load(memory_order_relaxed) == false &&
+                   record->inUse.compare_exchange_strong(inUse, true, memory_order_acquire))
+                    return record;
+            }
+            ThreadRecord* record = new ThreadRecord();
+            record->epoch.store(0, memory_order_relaxed);
+            record->inUse.store(true, memory_order_relaxed);
+            record->nesting = 0;
+            ThreadRecord* head = records.load(memory_order_relaxed);
+            do
+            {
+                record->next = head;
+            }while(records.compare_exchange_weak(head, record, memory_order_release, memory_order_relaxed) == false);
+            return record;
+        }
+
+        class RecordHolder
+        {
+        public:
+            RecordHolder(): m_record(AcquireRecord()){}
+            ~RecordHolder()
+            {
+                DeleteSafe(m_record->retired);
+                if(m_record->retired.empty() == false)
+                {
+                    lock_guard<mutex> lock(orphansMutex);
+                    orphans.insert(orphans.end(), m_record->retired.begin(), m_record->retired.end());
+                    m_record->retired.clear();
+                }
+                m_record->inUse.store(false, memory_order_release);
+            }
+            ThreadRecord* Get(){ return m_record; }
+
+        private:
+            ThreadRecord* m_record;
+        };
+
+        ThreadRecord* GetRecord()
+        {
+            static thread_local RecordHolder holder;
+            return holder.Get();
+        }
+    }
+
+    void Epoch::Enter()
+    {
+        ThreadRecord* record = GetRecord();
+        if(record->nesting++ != 0)
+            return;
+        record->epoch.store(globalEpoch.load(memory_order_relaxed), memory_order_seq_cst);
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+
+    void Epoch::Exit()
+    {
+        ThreadRecord* record = GetRecord();
+        if(--record->nesting == 0)
+            record->epoch.store(0, memory_order_release);
+    }
+
+    void Epoch::Retire(void* object, Deleter deleter)
+    {
+        ThreadRecord* record = GetRecord();
+        record->retired.push_back(RetiredObject{object, deleter, globalEpoch.load(memory_order_seq_cst)});
+        if(record->retired.size() % CollectInterval == 0)
+            Collect();
+    }
+
+    void Epoch::Collect()
+    {
+        ThreadRecord* record = GetRecord();
+        if(record->nesting == 0) //Our own critical section would hold the epoch back
+            TryAdvance();
+        DeleteSafe(record->retired);
+        CollectOrphans();
+    }
+
+    size_t Epoch::GetPendingCount()
+    {
+        return GetRecord()->retired.size();
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+
+namespace core
+{
+    //Epoch is a process wide epoch based reclamation domain. readers enter a critical section (Epoch::Guard) which only
+    //publishes the current epoch within the thread's own record (a cache line of its own), writers retire unlinked
+    //objects instead of deleting them, a retired object is deleted once every thread which might still observe it
+    //has left its critical section (the global epoch has advanced twice since).
+    class Epoch
+    {
+    public:
+        typedef void(*Deleter)(void*);
+
+        class Guard
+        {
+        public:
+            Guard(){ Epoch::Enter(); }
+            ~Guard(){ Epoch::Exit(); }
+            Guard(const Guard&) = delete;
+            Guard& operator=(const Guard&) = delete;
+        };
+
+        //Enter and Exit may be nested.
+        static void Enter();
+        static void Exit();
+
+        template<typename T>
+        static void Retire(T* object)
+        {
+            Retire(object, [](void* ptr){ delete static_cast<T*>(ptr); });
+        }
+
+        static void Retire(void* object, Deleter deleter);
+        //Collect attempts to advance the epoch and deletes the calling thread's objects which became safe to delete.
+        static void Collect();
+        //GetPendingCount returns the number of objects retired by the calling thread which were not deleted yet.
+        static std::size_t GetPendingCount();
+    };
+}
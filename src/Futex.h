@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <cerrno>
+#include <ctime>
+#include <cstdint>
+#if defined(__linux)
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#include "Exception.h"
+
+namespace core{
+
+    //Futex wraps the futex syscall over a 32 bit word, the word may be placed within a shared region.
+    //a PRIVATE futex is keyed by its virtual address only, sparing the kernel the shared mapping lookup, it must not be
+    //used for words accessed by several processes.
+    class Futex
+    {
+    public:
+        enum class Scope
+        {
+            PRIVATE,
+            SHARED
+        };
+
+        //Wait blocks while *word == expected, returns false only if timeout (relative) has elapsed.
+        static bool Wait(void* word, int expected, Scope scope = Scope::SHARED, const struct timespec* timeout = nullptr)
+        {
+        #if defined(__linux)
+            if(syscall(SYS_futex, word, Operation(FUTEX_WAIT, scope), expected, timeout, nullptr, 0) == -1 && errno == ETIMEDOUT)
+                return false;
+            return true;
+        #else
+            throw Exception(__CORE_SOURCE, "wait is not being supported by current platform");
+        #endif
+        }
+
+        template<typename Clock, typename Duration>
+        static bool WaitUntil(void* word, int expected, const std::chrono::time_point<Clock, Duration>& atime, Scope scope = Scope::SHARED)
+        {
+            auto remaining = atime - Clock::now();
+            if(remaining <= Clock::duration::zero())
+                return false;
+            struct timespec timeout = ToTimespec(remaining);
+            return Wait(word, expected, scope, &timeout);
+        }
+
+        static void Wake(void* word, int count, Scope scope = Scope::SHARED)
+        {
+        #if defined(__linux)
+            syscall(SYS_futex, word, Operation(FUTEX_WAKE, scope), count, nullptr, nullptr, 0);
+        #else
+            throw Exception(__CORE_SOURCE, "wake is not being supported by current platform");
+        #endif
+        }
+
+        //CmpRequeue wakes up to wakeCount waiters of word and moves up to requeueCount of the remaining onto target,
+        //provided *word == expected, otherwise returns false. both words must share the same scope.
+        static bool CmpRequeue(void* word, int expected, int wakeCount, void* target, int requeueCount, Scope scope = Scope::SHARED)
+        {
+        #if defined(__linux)
+            if(syscall(SYS_futex, word, Operation(FUTEX_CMP_REQUEUE, scope), wakeCount, reinterpret_cast<const struct timespec*>(static_cast<std::uintptr_t>(requeueCount)),
+                       target, expected) == -1 && errno == EAGAIN)
+                return false;
+            return true;
+        #else
+            throw Exception(__CORE_SOURCE, "requeue is not being supported by current platform");
+        #endif
+        }
+
+        template<typename Rep, typename Period>
+        static struct timespec ToTimespec(const std::chrono::duration<Rep, Period>& duration)
+        {
+            auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+            struct timespec timeout;
+            timeout.tv_sec = static_cast<time_t>(nanoseconds / 1000000000);
+            timeout.tv_nsec = static_cast<long>(nanoseconds % 1000000000);
+            return timeout;
+        }
+
+    private:
+        static int Operation(int operation, Scope scope)
+        {
+        #if defined(__linux)
+            return scope == Scope::PRIVATE ? operation | FUTEX_PRIVATE_FLAG : operation;
+        #else
+            return operation;
+        #endif
+        }
+    };
+}
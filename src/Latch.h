@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <limits>
+#include "Futex.h"
+
+namespace core{
+
+    //Latch is a single use count down, waiters are released once the count reaches zero. all of its state resides
+    //within the object, making it usable in shared memory (unless constructed with Futex::Scope::PRIVATE).
+    class Latch
+    {
+    public:
+        explicit Latch(int count, Futex::Scope scope = Futex::Scope::SHARED)
+            : m_count(count), m_waiters(0), m_scope(scope){}
+        Latch(const Latch&) = delete;
+        Latch& operator=(const Latch&) = delete;
+
+        //count_down releases the waiters with a single futex call, the syscall is skipped if no one sleeps.
+        void count_down(int update = 1)
+        {
+            if(m_count.fetch_sub(update, std::memory_order_seq_cst) == update && m_waiters.load(std::memory_order_seq_cst) != 0)
+                Futex::Wake(&m_count, std::numeric_limits<int>::max(), m_scope);
+        }
+
+        bool try_wait() const
+        {
+            return m_count.load(std::memory_order_acquire) <= 0;
+        }
+
+        void wait()
+        {
+            int count;
+            while((count = m_count.load(std::memory_order_acquire)) > 0)
+            {
+                m_waiters.fetch_add(1, std::memory_order_seq_cst);
+                if(m_count.load(std::memory_order_seq_cst) == count)
+                    Futex::Wait(&m_count, count, m_scope);
+                m_waiters.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        void arrive_and_wait(int update = 1)
+        {
+            count_down(update);
+            wait();
+        }
+
+    private:
+        std::atomic<int> m_count;
+        std::atomic<int> m_waiters;
+        const Futex::Scope m_scope;
+    };
+}
@@ -0,0 +1,144 @@
+#include "LockProfiler.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace core
+{
+    namespace
+    {
+        enum SourceState : int
+        {
+            NO_SOURCE = 0,
+            WRITING_SOURCE,
+            HAS_SOURCE
+        };
+
+        struct SiteEntry
+        {
+            atomic<uint64_t> key; //0 marks a free entry
+            atomic<int> sourceState;
+            Source source;
+            atomic<uint64_t> acquisitions;
+            atomic<uint64_t> contendedAcquisitions;
+            atomic<uint64_t> waitNanoseconds;
+            atomic<uint64_t> maxHoldNanoseconds;
+        };
+
+        //Zero initialized as a static, the last entry accounts the sites which didn't fit.
+        SiteEntry sites[LockProfiler::MaxSites + 1];
+
+        uint64_t SiteKey(const Source& source)
+        {
+            uint64_t hash = 14695981039346656037ULL;
+            for(const char* current = source.file; current && *current; current++)
+                hash = (hash ^ static_cast<unsigned char>(*current)) * 1099511628211ULL;
+            hash = (hash ^ static_cast<uint64_t>(source.line)) * 1099511628211ULL;
+            return hash == 0 ? 1 : hash;
+        }
+
+        SiteEntry& FindEntry(uint64_t key)
+        {
+            for(int probe = 0; probe < LockProfiler::MaxSites; probe++)
+            {
+                SiteEntry& entry = sites[(key + probe) % LockProfiler::MaxSites];
+                uint64_t entryKey = entry.key.load(memory_order_acquire);
+                if(entryKey == key)
+                    return entry;
+                if(entryKey == 0 && entry.key.compare_exchange_strong(entryKey, key, memory_order_acq_rel))
+                    return entry;
+                if(entryKey == key) //Claimed by another thread in between
+                    return entry;
+            }
+            return sites[LockProfiler::MaxSites];
+        }
+    }
+
+    uint64_t LockProfiler::Register(const Source& source)
+    {
+        uint64_t key = SiteKey(source);
+        SiteEntry& entry = FindEntry(key);
+        int state = NO_SOURCE;
+        if(&entry != &sites[MaxSites] && entry.sourceState.compare_exchange_strong(state, static_cast<int>(WRITING_SOURCE)))
+        {
+            entry.source = source;
+            entry.sourceState.store(HAS_SOURCE, memory_order_release);
+        }
+        return key;
+    }
+
+    void LockProfiler::OnAcquire(uint64_t key, int64_t waitNanoseconds, bool contended)
+    {
+        SiteEntry& entry = FindEntry(key);
+        entry.acquisitions.fetch_add(1, memory_order_relaxed);
+        if(contended)
+        {
+            entry.contendedAcquisitions.fetch_add(1, memory_order_relaxed);
+            entry.waitNanoseconds.fetch_add(static_cast<uint64_t>(max<int64_t>(waitNanoseconds, 0)), memory_order_relaxed);
+        }
+    }
+
+    void LockProfiler::OnRelease(uint64_t key, int64_t holdNanoseconds)
+    {
+        SiteEntry& entry = FindEntry(key);
+        uint64_t hold = static_cast<uint64_t>(max<int64_t>(holdNanoseconds, 0));
+        uint64_t maxHold = entry.maxHoldNanoseconds.load(memory_order_relaxed);
+        while(hold > maxHold && entry.maxHoldNanoseconds.compare_exchange_weak(maxHold, hold, memory_order_relaxed) == false);
+    }
+
+    vector<LockSiteStatistics> LockProfiler::Collect()
+    {
+        vector<LockSiteStatistics> statistics;
+        for(SiteEntry& entry : sites)
+        {
+            LockSiteStatistics site = {Source{nullptr, nullptr, 0},
+                                       entry.acquisitions.load(memory_order_relaxed),
+                                       entry.contendedAcquisitions.load(memory_order_relaxed),
+                                       entry.waitNanoseconds.load(memory_order_relaxed),
+                                       entry.maxHoldNanoseconds.load(memory_order_relaxed)};
+            if(site.acquisitions == 0)
+                continue;
+            if(entry.sourceState.load(memory_order_acquire) == HAS_SOURCE)
+                site.source = entry.source;
+            statistics.push_back(site);
+        }
+        sort(statistics.begin(), statistics.end(), [](const LockSiteStatistics& lhs, const LockSiteStatistics& rhs){
+            return lhs.waitNanoseconds > rhs.waitNanoseconds;
+        });
+        return statistics;
+    }
+
+    string LockProfiler::Report()
+    {
+        stringstream ss;
+        for(const LockSiteStatistics& site : Collect())
+        {
+            if(site.source.file)
+                ss << site.source.file << ":" << site.source.line << " (" << site.source.function << ")";
+            else
+                ss << "unknown site";
+            ss << ": acquisitions=" << site.acquisitions << " contended=" << site.contendedAcquisitions
+               << " wait=" << site.waitNanoseconds << "ns maxHold=" << site.maxHoldNanoseconds << "ns\n";
+        }
+        return ss.str();
+    }
+
+    void LockProfiler::Reset()
+    {
+        for(SiteEntry& entry : sites)
+        {
+            entry.acquisitions.store(0, memory_order_relaxed);
+            entry.contendedAcquisitions.store(0, memory_order_relaxed);
+            entry.waitNanoseconds.store(0, memory_order_relaxed);
+            entry.maxHoldNanoseconds.store(0, memory_order_relaxed);
+        }
+    }
+
+    int64_t LockProfiler::Now()
+    {
+        return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include "Source.h"
+
+//The caller's site, as a default argument, where the compiler provides it, an empty source otherwise.
+#if defined(__GNUC__)
+#define __CORE_CALLER_FILE __builtin_FILE()
+#define __CORE_CALLER_FUNCTION __builtin_FUNCTION()
+#define __CORE_CALLER_LINE __builtin_LINE()
+#else
+#define __CORE_CALLER_FILE nullptr
+#define __CORE_CALLER_FUNCTION nullptr
+#define __CORE_CALLER_LINE 0
+#endif
+
+namespace core
+{
+    //LockSiteStatistics is a snapshot of the counters recorded for all locks constructed at a single site.
+    struct LockSiteStatistics
+    {
+        Source source; //file is null for sites registered by another process (the lock resides in shared memory)
+        std::uint64_t acquisitions;
+        std::uint64_t contendedAcquisitions;
+        std::uint64_t waitNanoseconds;
+        std::uint64_t maxHoldNanoseconds;
+    };
+
+    //LockProfiler aggregates lock statistics per construction site within a process local, lock free table.
+    //sites are identified by a key derived from their file and line, a lock stores the key rather than a pointer,
+    //so a profiled lock placed in shared memory is accounted by every process using it.
+    class LockProfiler
+    {
+    public:
+        static const int MaxSites = 1024; //Sites beyond are accounted under a single overflow entry
+
+        static std::uint64_t Register(const Source& source);
+        static void OnAcquire(std::uint64_t key, std::int64_t waitNanoseconds, bool contended);
+        static void OnRelease(std::uint64_t key, std::int64_t holdNanoseconds);
+        static std::vector<LockSiteStatistics> Collect(); //Sorted by descending wait time
+        static std::string Report();
+        static void Reset();
+
+        //CallerSource captures the site of the call whose default argument it is.
+        static Source CallerSource(const char* file = __CORE_CALLER_FILE, const char* function = __CORE_CALLER_FUNCTION, int line = __CORE_CALLER_LINE)
+        {
+            return Source{file, function, line};
+        }
+
+        static std::int64_t Now();
+    };
+
+    //LockProbe records the acquisitions and releases of a single lock instance.
+    class LockProbe
+    {
+    public:
+        explicit LockProbe(const Source& source): m_key(LockProfiler::Register(source)), m_acquireTime(0){}
+
+        //waitStart is the time the acquirer started waiting, or 0 for an uncontended acquisition.
+        void OnAcquire(std::int64_t waitStart)
+        {
+            m_acquireTime = LockProfiler::Now();
+            LockProfiler::OnAcquire(m_key, waitStart == 0 ? 0 : m_acquireTime - waitStart, waitStart != 0);
+        }
+
+        void OnRelease()
+        {
+            LockProfiler::OnRelease(m_key, LockProfiler::Now() - m_acquireTime);
+        }
+
+    private:
+        std::uint64_t m_key;
+        std::int64_t m_acquireTime; //Accessed by the owner only
+    };
+
+    //ProfiledLock wraps any lockable, accounting it under its construction site.
+    template<typename Lockable>
+    class ProfiledLock
+    {
+    public:
+        explicit ProfiledLock(const Source& source = LockProfiler::CallerSource()): m_probe(source){}
+        ProfiledLock(const ProfiledLock&) = delete;
+        ProfiledLock& operator=(const ProfiledLock&) = delete;
+
+        void lock()
+        {
+            if(m_lockable.try_lock())
+            {
+                m_probe.OnAcquire(0);
+                return;
+            }
+            std::int64_t waitStart = LockProfiler::Now();
+            m_lockable.lock();
+            m_probe.OnAcquire(waitStart);
+        }
+
+        bool try_lock()
+        {
+            if(m_lockable.try_lock() == false)
+                return false;
+            m_probe.OnAcquire(0);
+            return true;
+        }
+
+        void unlock()
+        {
+            m_probe.OnRelease();
+            m_lockable.unlock();
+        }
+
+    private:
+        Lockable m_lockable;
+        LockProbe m_probe;
+    };
+
+    //LockSite carries the construction site of a core lock, it's empty unless built with CORE_LOCK_PROFILING.
+    struct LockSite
+    {
+        static LockSite Current(const char* file = __CORE_CALLER_FILE, const char* function = __CORE_CALLER_FUNCTION, int line = __CORE_CALLER_LINE)
+        {
+        #if defined(CORE_LOCK_PROFILING)
+            return LockSite{Source{file, function, line}};
+        #else
+            return LockSite{};
+        #endif
+        }
+
+    #if defined(CORE_LOCK_PROFILING)
+        Source source;
+    #endif
+    };
+
+    //ProfiledMutex is the std::mutex used by the containers, profiled under CORE_LOCK_PROFILING, a plain std::mutex
+    //otherwise. ProfiledMutexLock and ProfiledConditionVariable are its matching lock and condition types.
+#if defined(CORE_LOCK_PROFILING)
+    class ProfiledMutex : public ProfiledLock<std::mutex>
+    {
+    public:
+        explicit ProfiledMutex(const LockSite& site = LockSite::Current()): ProfiledLock<std::mutex>(site.source){}
+    };
+    typedef std::unique_lock<ProfiledMutex> ProfiledMutexLock;
+    typedef std::condition_variable_any ProfiledConditionVariable;
+#else
+    class ProfiledMutex : public std::mutex
+    {
+    public:
+        explicit ProfiledMutex(const LockSite& = LockSite::Current()){}
+    };
+    typedef std::unique_lock<std::mutex> ProfiledMutexLock;
+    typedef std::condition_variable ProfiledConditionVariable;
+#endif
+}
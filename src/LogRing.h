@@ -0,0 +1,244 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <ctime>
+#include "Futex.h"
+
+namespace core{
+
+    //LogRing is a bounded, lock free, multi producers single consumer ring of variable sized records. the ring is
+    //made of cache line cells, each carrying a sequence (Vyukov's bounded queue), a record claims consecutive cells
+    //with a single CAS over the tail and is published by its first cell's sequence. the consumer sleeps on a futex
+    //once the ring is empty, producers issue a wake only when it does, blocked producers sleep on a futex the consumer
+    //bumps as it frees cells.
+    class LogRing
+    {
+    public:
+        static const std::size_t CellDataSize = 48;
+
+        //cellsCount is rounded up to a power of 2, a record may span all of the cells.
+        explicit LogRing(std::size_t cellsCount): m_tail(0), m_consumerSleeping(0), m_freeEvent(0), m_blockedProducers(0),
+            m_head(0), m_consumed(0)
+        {
+            m_cellsCount = 1;
+            while(m_cellsCount < cellsCount)
+                m_cellsCount <<= 1;
+            m_buffer.reset(new char[m_cellsCount * sizeof(Cell) + CacheLineSize]);
+            std::uintptr_t address = reinterpret_cast<std::uintptr_t>(m_buffer.get());
+            m_cells = reinterpret_cast<Cell*>((address + CacheLineSize - 1) & ~(static_cast<std::uintptr_t>(CacheLineSize) - 1));
+            for(std::size_t idx = 0; idx < m_cellsCount; idx++)
+                new(&m_cells[idx].sequence)std::atomic<std::uint64_t>(idx);
+        }
+        LogRing(const LogRing&) = delete;
+        LogRing& operator=(const LogRing&) = delete;
+
+        std::size_t GetMaxRecordSize() const { return m_cellsCount * CellDataSize; }
+
+        //TryPush returns false if the ring has no room for the record, size must not exceed GetMaxRecordSize.
+        bool TryPush(std::uint32_t tag, const char* data, std::size_t size)
+        {
+            return TryPush(tag, nullptr, 0, data, size);
+        }
+
+        //TryPush pushes a record made of header followed by data, sparing the caller their concatenation.
+        bool TryPush(std::uint32_t tag, const char* header, std::size_t headerSize, const char* data, std::size_t size)
+        {
+            std::size_t cellsCount = CellsOf(headerSize + size);
+            std::uint64_t position = m_tail.load(std::memory_order_relaxed);
+            while(true)
+            {
+                //The consumer frees cells in order, once the last cell is free so are the ones before it
+                std::uint64_t last = position + cellsCount - 1;
+                std::int64_t diff = static_cast<std::int64_t>(At(last).sequence.load(std::memory_order_acquire) - last);
+                if(diff == 0)
+                {
+                    if(m_tail.compare_exchange_weak(position, position + cellsCount, std::memory_order_relaxed))
+                        break;
+                }
+                else if(diff < 0)
+                    return false;
+                else
+                    position = m_tail.load(std::memory_order_relaxed);
+            }
+
+            Cell& first = At(position);
+            first.size = static_cast<std::uint32_t>(headerSize + size);
+            first.tag = tag;
+            CopyIn(position, 0, header, headerSize);
+            CopyIn(position, headerSize, data, size);
+            first.sequence.store(position + 1, std::memory_order_release);
+            NotifyConsumer();
+            return true;
+        }
+
+        //Push waits for room within the ring.
+        void Push(std::uint32_t tag, const char* data, std::size_t size)
+        {
+            Push(tag, nullptr, 0, data, size);
+        }
+
+        void Push(std::uint32_t tag, const char* header, std::size_t headerSize, const char* data, std::size_t size)
+        {
+            if(TryPush(tag, header, headerSize, data, size))
+                return;
+            m_blockedProducers.fetch_add(1, std::memory_order_seq_cst);
+            while(true)
+            {
+                int event = m_freeEvent.load(std::memory_order_seq_cst);
+                if(TryPush(tag, header, headerSize, data, size))
+                    break;
+                WakeConsumer();
+                Futex::Wait(&m_freeEvent, event, Futex::Scope::PRIVATE);
+            }
+            m_blockedProducers.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        //Consume calls consumer(tag, data, size) for up to maxCount published records, in order, returns the number
+        //consumed. data is valid for the duration of the call only. must be called by the consumer only.
+        template<typename Consumer>
+        std::size_t Consume(const Consumer& consumer, std::size_t maxCount = std::numeric_limits<std::size_t>::max())
+        {
+            std::size_t count = 0;
+            for(; count < maxCount; count++)
+            {
+                Cell& first = At(m_head);
+                if(first.sequence.load(std::memory_order_acquire) != m_head + 1)
+                    break;
+                std::size_t size = first.size;
+                std::size_t cellsCount = CellsOf(size);
+                const char* data = first.data;
+                if(cellsCount > 1)
+                {
+                    m_scratch.resize(size);
+                    for(std::size_t idx = 0, offset = 0; offset < size; idx++, offset += CellDataSize)
+                        std::memcpy(&m_scratch[offset], At(m_head + idx).data, size - offset < CellDataSize ? size - offset : CellDataSize);
+                    data = m_scratch.data();
+                }
+                consumer(first.tag, data, size);
+                for(std::size_t idx = 0; idx < cellsCount; idx++)
+                    At(m_head + idx).sequence.store(m_head + idx + m_cellsCount, std::memory_order_release);
+                m_head += cellsCount;
+            }
+            if(count != 0)
+            {
+                m_consumed.store(m_head, std::memory_order_release);
+                NotifyProducers();
+            }
+            return count;
+        }
+
+        //WaitForRecords blocks the consumer while the ring is empty, up to timeout, or until WakeConsumer is called.
+        void WaitForRecords(const struct timespec& timeout)
+        {
+            m_consumerSleeping.store(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if(At(m_head).sequence.load(std::memory_order_acquire) == m_head + 1)
+            {
+                m_consumerSleeping.store(0, std::memory_order_relaxed);
+                return;
+            }
+            Futex::Wait(&m_consumerSleeping, 1, Futex::Scope::PRIVATE, &timeout);
+            m_consumerSleeping.store(0, std::memory_order_relaxed);
+        }
+
+        void WakeConsumer()
+        {
+            if(m_consumerSleeping.exchange(0, std::memory_order_seq_cst) != 0)
+                Futex::Wake(&m_consumerSleeping, 1, Futex::Scope::PRIVATE);
+        }
+
+        //GetTail returns the position past the last claimed cell, GetConsumed the position past the last consumed one,
+        //once GetConsumed reaches a previously read GetTail, all of the records pushed before it were consumed.
+        std::uint64_t GetTail() const { return m_tail.load(std::memory_order_acquire); }
+        std::uint64_t GetConsumed() const { return m_consumed.load(std::memory_order_acquire); }
+
+        //Reset returns the ring to its initial state, used by a forked child whose copy of the ring may hold cells
+        //claimed but never published by its parent's threads (or being freed by its writer), which can't be drained.
+        //no other thread may access the ring meanwhile.
+        void Reset()
+        {
+            for(std::size_t idx = 0; idx < m_cellsCount; idx++)
+                m_cells[idx].sequence.store(idx, std::memory_order_relaxed);
+            m_tail.store(0, std::memory_order_relaxed);
+            m_head = 0;
+            m_consumed.store(0, std::memory_order_relaxed);
+            m_consumerSleeping.store(0, std::memory_order_relaxed);
+            m_freeEvent.store(0, std::memory_order_relaxed);
+            m_blockedProducers.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        static const std::size_t CacheLineSize = 64;
+
+        struct Cell
+        {
+            std::atomic<std::uint64_t> sequence;
+            std::uint32_t size; //Of the record, valid within its first cell only
+            std::uint32_t tag;
+            char data[CellDataSize];
+        };
+        static_assert(sizeof(Cell) == CacheLineSize, "A cell is expected to occupy a single cache line");
+
+        Cell& At(std::uint64_t position) { return m_cells[position & (m_cellsCount - 1)]; }
+
+        //CopyIn copies size bytes into the record claimed at position, at the record's offset.
+        void CopyIn(std::uint64_t position, std::size_t offset, const char* data, std::size_t size)
+        {
+            while(size != 0)
+            {
+                std::size_t cellOffset = offset % CellDataSize;
+                std::size_t chunk = CellDataSize - cellOffset < size ? CellDataSize - cellOffset : size;
+                std::memcpy(At(position + offset / CellDataSize).data + cellOffset, data, chunk);
+                data += chunk;
+                offset += chunk;
+                size -= chunk;
+            }
+        }
+
+        static std::size_t CellsOf(std::size_t size)
+        {
+            return size == 0 ? 1 : (size + CellDataSize - 1) / CellDataSize;
+        }
+
+        void NotifyConsumer()
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst); //Pairs with the consumer's fence in WaitForRecords
+            if(m_consumerSleeping.load(std::memory_order_relaxed) != 0)
+                WakeConsumer();
+        }
+
+        void NotifyProducers()
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if(m_blockedProducers.load(std::memory_order_relaxed) != 0)
+            {
+                m_freeEvent.fetch_add(1, std::memory_order_seq_cst);
+                Futex::Wake(&m_freeEvent, std::numeric_limits<int>::max(), Futex::Scope::PRIVATE);
+            }
+        }
+
+    private:
+        //The ring is a member of heap allocated loggers (new doesn't honour an extended alignment), the producers' and
+        //the consumer's fields are kept apart by padding.
+        std::size_t m_cellsCount;
+        std::unique_ptr<char[]> m_buffer;
+        Cell* m_cells;
+        char m_tailPadding[CacheLineSize];
+        std::atomic<std::uint64_t> m_tail;
+        char m_sleepingPadding[CacheLineSize];
+        std::atomic<int> m_consumerSleeping;
+        char m_freeEventPadding[CacheLineSize];
+        std::atomic<int> m_freeEvent;
+        std::atomic<int> m_blockedProducers;
+        char m_headPadding[CacheLineSize];
+        std::uint64_t m_head; //Consumer's only
+        std::atomic<std::uint64_t> m_consumed;
+        std::vector<char> m_scratch;
+        char m_trailingPadding[CacheLineSize];
+    };
+}
@@ -28,7 +28,16 @@ namespace core
     {
     }
 
-    Logger::Logger(): m_severity(TraceSeverity::NoneWorking)
+    std::string FormatDeferred(const Source& source, const char* format, ...)
+    {
+        va_list arguments;
+        va_start(arguments, format);
+        std::string message = Logger::BuildMessageV(source, format, arguments);
+        va_end(arguments);
+        return message;
+    }
+
+    Logger::Logger(): m_severity(TraceSeverity::NoneWorking), m_deferredFormattingEnabled(true), m_deferredFormatting(false)
     {
         Environment::Instance().Init();
     }
@@ -73,16 +82,33 @@ namespace core
     void Logger::SetImpl(unique_ptr<LoggerImpl> loggerImpl)
     {
         swap(m_loggerImpl, loggerImpl);
+        UpdateDeferredFormatting();
     }
 
     void Logger::Start(TraceSeverity severity)
     {
         if(m_loggerImpl.get() == nullptr)
             m_loggerImpl.reset(new DefaultLogger());
-        assert(!m_running.exchange(true, std::memory_order_relaxed));
+        bool running = m_running.exchange(true, std::memory_order_relaxed); //Kept out of the assert, which NDEBUG drops
+        assert(!running);
+        (void)running;
         m_loggerImpl->Start(severity);
         m_severity = severity;
+        UpdateDeferredFormatting();
+    }
+    void Logger::SetDeferredFormatting(bool deferred)
+    {
+        m_deferredFormattingEnabled = deferred;
+        UpdateDeferredFormatting();
     }
+
+    void Logger::UpdateDeferredFormatting()
+    {
+        bool deferred = m_running.load(std::memory_order_relaxed) && m_deferredFormattingEnabled &&
+            m_loggerImpl && m_loggerImpl->SupportsDeferredFormatting();
+        m_deferredFormatting.store(deferred, std::memory_order_relaxed);
+    }
+
     void Logger::Log(TraceSeverity severity, const char* message)
     {
         assert(m_loggerImpl.get() != nullptr);
@@ -9,6 +9,7 @@
 #include <mutex>
 #include <tuple>
 #include <ctime>
+#include <chrono>
 #include <vector>
 #include <algorithm>
 #if defined(__linux)
@@ -16,6 +17,7 @@
 #endif
 #include "Source.h"
 #include "LoggerImpl.h"
+#include "DeferredRecord.h"
 #include "Export.h"
 
 namespace core
@@ -42,17 +44,44 @@ namespace core
         CORE_EXPORT static Logger& Instance();
         CORE_EXPORT ~Logger(); //add nullptr to release the blocked wait. not by cancel of the thread.
         void AddListener(const std::shared_ptr<TraceListener>& listener);
-        std::string BuildMessage(const Source& source, const char* format, ...);
+        static std::string BuildMessage(const Source& source, const char* format, ...);
+        static std::string BuildMessageV(const Source& source, const char* format, va_list arguments);
         void SetImpl(std::unique_ptr<LoggerImpl> loggerImpl);
         CORE_EXPORT void Start(TraceSeverity severity);
+        //SetDeferredFormatting picks whether traces are formatted by the logger's background thread (the default, where
+        //the logger supports it) or at the call site.
+        CORE_EXPORT void SetDeferredFormatting(bool deferred);
         CORE_EXPORT void Terminate();
         template<typename... Args>
         void Trace(TraceSeverity severity, const Source& source, const char* format, Args... args)
         {
             ValidateParams<Args...>();
+            if(m_deferredFormatting.load(std::memory_order_relaxed))
+            {
+                TraceDeferred(severity, source, format, args...);
+                return;
+            }
             std::string message = BuildMessage(source, format, args...);
             Log(severity, message.c_str());
         }
+        //TraceDeferred captures the trace as a DeferredRecord, leaving its formatting to the logger. the arguments are
+        //taken by value, so arrays (string literals included) decay into c strings, which are copied by content.
+        template<typename... Args>
+        void TraceDeferred(TraceSeverity severity, const Source& source, const char* format, Args... args)
+        {
+            std::size_t size = DeferredRecord<Args...>::Size(args...);
+            if(size > static_cast<std::size_t>(Local_buffer_size))
+            {
+                std::string message = BuildMessage(source, format, args...);
+                Log(severity, message.c_str());
+                return;
+            }
+            char record[Local_buffer_size];
+            std::int64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            DeferredRecord<Args...>::Encode(record, source, format, timestamp, args...);
+            m_loggerImpl->LogDeferred(severity, record, size);
+        }
         template<typename... Args>
         static typename std::enable_if<Comperator<Args...>::value>::type ValidateParams(){} //Due to VS2013 limitation on expression SFIANE
         template<typename X, typename... Args>
@@ -98,12 +127,15 @@ namespace core
         Logger();
         std::tuple<FileName, Line, FunctionName> GetFunctionAndLine(char* mangledSymbol);
         void SetDefaultLogger();
+        void UpdateDeferredFormatting();
         
     private:
         std::list<std::shared_ptr<TraceListener>> m_listeners;
         std::unique_ptr<LoggerImpl> m_loggerImpl;
         std::atomic_bool m_running;
         TraceSeverity m_severity;
+        bool m_deferredFormattingEnabled;
+        std::atomic<bool> m_deferredFormatting; //Takes effect once the logger is started
         mutable std::mutex m_mut;
         static const int Local_buffer_size = 2000;
     };
@@ -113,8 +145,16 @@ namespace core
     {
         va_list arguments;
         va_start(arguments, format);
-        std::string result;
+        std::string result = BuildMessageV(source, format, arguments);
+        va_end(arguments);
+        return result;
+    }
 
+    inline std::string Logger::BuildMessageV(const Source& source, const char* format, va_list arguments)
+    {
+        va_list retryArguments; //The arguments are consumed by the first attempt
+        va_copy(retryArguments, arguments);
+        std::string result;
         char buf[Local_buffer_size] = "";
 #if defined(WIN32)
         int size = _snprintf_s(buf, Local_buffer_size,  Local_buffer_size - 1, "%s:%s:%d\t", source.file,
@@ -148,15 +188,15 @@ namespace core
 #endif
             assert(largerSize != -1 && largerSize < bufferSize); //In windows version -1 is a legit answer
 #if defined(WIN32)
-            vsprintf_s(&largerBuf[largerSize], bufferSize - largerSize, format, arguments); //We will print what we can, no second resize.
+            vsprintf_s(&largerBuf[largerSize], bufferSize - largerSize, format, retryArguments); //We will print what we can, no second resize.
 #else
-            int remainSize = vsnprintf(&largerBuf[largerSize], bufferSize - largerSize, format, arguments);
+            int remainSize = vsnprintf(&largerBuf[largerSize], bufferSize - largerSize, format, retryArguments);
             assert(remainSize >= 0); //We will print what we can, no second resize.
 #endif
             result = std::string(largerBuf.begin(), largerBuf.end());
         }
 
-        va_end(arguments);
+        va_end(retryArguments);
         return result;
     }
 }
@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <string>
+#include "DeferredRecord.h"
 
 namespace core
 {
@@ -16,5 +17,14 @@ namespace core
         virtual void Log(TraceSeverity, const std::string&) = 0;
         virtual void Flush() = 0;
         virtual void AddListener(const std::shared_ptr<TraceListener>& listener) = 0;
+        //LogDeferred receives a DeferredRecord, implementations which don't support deferred formatting have it
+        //formatted right away.
+        virtual void LogDeferred(TraceSeverity severity, const char* record, std::size_t)
+        {
+            std::string message;
+            FormatDeferredRecord(record, message);
+            Log(severity, message);
+        }
+        virtual bool SupportsDeferredFormatting() const { return false; }
     };
 }
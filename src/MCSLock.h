@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include "Futex.h"
+#include "Cpu.h"
+#include "LockProfiler.h"
+#include "Assert.h"
+
+namespace core{
+
+    //MCSLock is a fair, queue based lock, waiters are granted the lock in arrival order, each spinning on its own
+    //queue node (a cache line of its own), so a release touches the line of the next waiter only. a waiter which
+    //spun for long parks on a private futex over its node. nodes are taken from a small per thread pool, so a thread
+    //may hold up to MaxNesting MCS locks at once. the lock is process local, see TicketLock for shared memory.
+    class MCSLock
+    {
+    public:
+        static const int MaxNesting = 8;
+
+        explicit MCSLock(const LockSite& site = LockSite::Current())
+            : m_tail(nullptr), m_owner(nullptr)
+        #if defined(CORE_LOCK_PROFILING)
+            , m_probe(site.source)
+        #endif
+        {}
+        MCSLock(const MCSLock&) = delete;
+        MCSLock& operator=(const MCSLock&) = delete;
+
+        void lock()
+        {
+            Node* node = AcquireNode();
+            Node* predecessor = m_tail.exchange(node, std::memory_order_acq_rel);
+            if(predecessor == nullptr)
+            {
+                OnAcquire(node, 0);
+                return;
+            }
+
+            std::int64_t waitStart = WaitStart();
+            predecessor->next.store(node, std::memory_order_release);
+            const int spinCount = 1000;
+            for(int spin = 0; node->state.load(std::memory_order_acquire) != GRANTED; spin++)
+            {
+                if(spin < spinCount)
+                {
+                    CpuRelax();
+                    continue;
+                }
+                int state = WAITING;
+                if(node->state.compare_exchange_strong(state, static_cast<int>(PARKED), std::memory_order_acq_rel) || state == PARKED)
+                    Futex::Wait(&node->state, PARKED, Futex::Scope::PRIVATE);
+            }
+            OnAcquire(node, waitStart);
+        }
+
+        bool try_lock()
+        {
+            Node* node = AcquireNode();
+            Node* free = nullptr;
+            if(m_tail.compare_exchange_strong(free, node, std::memory_order_acq_rel) == false)
+            {
+                ReleaseNode(node);
+                return false;
+            }
+            OnAcquire(node, 0);
+            return true;
+        }
+
+        void unlock()
+        {
+        #if defined(CORE_LOCK_PROFILING)
+            m_probe.OnRelease();
+        #endif
+            Node* node = m_owner;
+            Node* successor = node->next.load(std::memory_order_acquire);
+            if(successor == nullptr)
+            {
+                Node* expected = node;
+                if(m_tail.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel))
+                {
+                    ReleaseNode(node);
+                    return;
+                }
+                //A waiter has swapped the tail but didn't link itself yet.
+                while((successor = node->next.load(std::memory_order_acquire)) == nullptr)
+                    CpuRelax();
+            }
+            ReleaseNode(node);
+            if(successor->state.exchange(GRANTED, std::memory_order_acq_rel) == PARKED)
+                Futex::Wake(&successor->state, 1, Futex::Scope::PRIVATE);
+        }
+
+    private:
+        enum State : int
+        {
+            WAITING = 0,
+            PARKED,
+            GRANTED
+        };
+
+        struct alignas(64) Node
+        {
+            std::atomic<Node*> next;
+            std::atomic<int> state;
+            bool inUse;
+        };
+
+        static Node* AcquireNode()
+        {
+            static thread_local Node nodes[MaxNesting] = {};
+            for(Node& node : nodes)
+            {
+                if(node.inUse == false)
+                {
+                    node.inUse = true;
+                    node.next.store(nullptr, std::memory_order_relaxed);
+                    node.state.store(WAITING, std::memory_order_relaxed);
+                    return &node;
+                }
+            }
+            throw Exception(__CORE_SOURCE, "A thread may not hold more than %d MCS locks at once", +MaxNesting);
+        }
+
+        static void ReleaseNode(Node* node)
+        {
+            node->inUse = false;
+        }
+
+        std::int64_t WaitStart()
+        {
+        #if defined(CORE_LOCK_PROFILING)
+            return LockProfiler::Now();
+        #else
+            return 0;
+        #endif
+        }
+
+        void OnAcquire(Node* node, std::int64_t waitStart)
+        {
+            m_owner = node;
+        #if defined(CORE_LOCK_PROFILING)
+            m_probe.OnAcquire(waitStart);
+        #endif
+        }
+
+    private:
+        alignas(64) std::atomic<Node*> m_tail;
+        Node* m_owner; //Accessed by the owner only
+    #if defined(CORE_LOCK_PROFILING)
+        LockProbe m_probe;
+    #endif
+    };
+}
@@ -0,0 +1,66 @@
+#include "MonotonicArena.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace core
+{
+    MonotonicArena::MonotonicArena(std::size_t blockSize)
+        :m_blockSize(blockSize), m_head(nullptr), m_cursor(nullptr), m_end(nullptr), m_releasedUsedSize(0){}
+
+    MonotonicArena::~MonotonicArena()
+    {
+        ReleaseBlocks(m_head);
+    }
+
+    void* MonotonicArena::AllocateSlow(std::size_t size, std::size_t alignment)
+    {
+        if(m_head != nullptr)
+            m_releasedUsedSize += m_cursor - BlockBegin(m_head);
+
+        std::size_t blockSize = std::max(m_blockSize, size + alignment);
+        Block* block = static_cast<Block*>(std::malloc(sizeof(Block) + blockSize));
+        if(block == nullptr)
+            throw std::bad_alloc();
+        block->next = m_head;
+        block->size = blockSize;
+        m_head = block;
+        m_end = BlockBegin(block) + blockSize;
+
+        char* ptr = Align(BlockBegin(block), alignment);
+        m_cursor = ptr + size;
+        return ptr;
+    }
+
+    void MonotonicArena::Reset()
+    {
+        if(m_head == nullptr)
+            return;
+        ReleaseBlocks(m_head->next);
+        m_head->next = nullptr;
+        m_cursor = BlockBegin(m_head);
+        m_releasedUsedSize = 0;
+    }
+
+    std::size_t MonotonicArena::GetUsedSize() const
+    {
+        return m_head == nullptr ? 0 : m_releasedUsedSize + (m_cursor - BlockBegin(m_head));
+    }
+
+    std::size_t MonotonicArena::GetReservedSize() const
+    {
+        std::size_t reservedSize = 0;
+        for(Block* block = m_head; block != nullptr; block = block->next)
+            reservedSize += block->size;
+        return reservedSize;
+    }
+
+    void MonotonicArena::ReleaseBlocks(Block* block)
+    {
+        while(block != nullptr)
+        {
+            Block* next = block->next;
+            std::free(block);
+            block = next;
+        }
+    }
+}
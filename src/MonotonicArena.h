@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace core
+{
+    //MonotonicArena hands out memory by bumping a cursor within its current block, upon exhaustion a new block is
+    //chained. individual deallocations are not supported, all the memory is released in bulk by Reset (keeping the
+    //last block for reuse) or upon destruction. the arena is not synchronized, a single arena per thread/request is expected.
+    class MonotonicArena
+    {
+    public:
+        explicit MonotonicArena(std::size_t blockSize = 64 * 1024);
+        ~MonotonicArena();
+        MonotonicArena(const MonotonicArena&) = delete;
+        MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+        void* Allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+        {
+            if(m_cursor == nullptr)
+                return AllocateSlow(size, alignment);
+            char* ptr = Align(m_cursor, alignment);
+            if(ptr > m_end || static_cast<std::size_t>(m_end - ptr) < size)
+                return AllocateSlow(size, alignment);
+            m_cursor = ptr + size;
+            return ptr;
+        }
+
+        void Reset();
+        std::size_t GetUsedSize() const;
+        std::size_t GetReservedSize() const;
+
+    private:
+        struct Block
+        {
+            Block* next;
+            std::size_t size;
+        };
+
+        static char* Align(char* ptr, std::size_t alignment)
+        {
+            std::uintptr_t address = reinterpret_cast<std::uintptr_t>(ptr);
+            return reinterpret_cast<char*>((address + alignment - 1) & ~(alignment - 1));
+        }
+        static char* BlockBegin(Block* block){ return reinterpret_cast<char*>(block + 1); }
+        void* AllocateSlow(std::size_t size, std::size_t alignment);
+        void ReleaseBlocks(Block* block);
+
+    private:
+        const std::size_t m_blockSize;
+        Block* m_head;
+        char* m_cursor;
+        char* m_end;
+        std::size_t m_releasedUsedSize; //Used size of all blocks preceding the current one
+    };
+
+    //ArenaAllocator is a standard conforming allocator adapter over a MonotonicArena, deallocate is a no-op,
+    //the memory is reclaimed upon the arena reset. allocators are equal when they share the same arena.
+    template<typename T>
+    class ArenaAllocator
+    {
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef std::true_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        template<typename T1>
+        struct rebind
+        {
+            typedef ArenaAllocator<T1> other;
+        };
+
+        explicit ArenaAllocator(MonotonicArena& arena) noexcept: m_arena(&arena){}
+        template<typename T1>
+        ArenaAllocator(const ArenaAllocator<T1>& object) noexcept: m_arena(object.m_arena){}
+
+        pointer allocate(size_type n, const void* hint = nullptr)
+        {
+            return static_cast<pointer>(m_arena->Allocate(n * sizeof(value_type), alignof(value_type)));
+        }
+
+        void deallocate(pointer p, size_type n) noexcept {}
+
+        template<typename U, typename... Args>
+        void construct(U* p, Args&&... args)
+        {
+            ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+        }
+
+        template<typename U>
+        void destroy(U* p)
+        {
+            p->~U();
+        }
+
+        MonotonicArena& arena() const noexcept { return *m_arena; }
+
+        template<typename T1, typename T2>
+        friend bool operator==(const ArenaAllocator<T1>& lhs, const ArenaAllocator<T2>& rhs) noexcept;
+
+    private:
+        template<typename T1> friend class ArenaAllocator;
+        MonotonicArena* m_arena;
+    };
+
+    template<typename T1, typename T2>
+    bool operator==(const ArenaAllocator<T1>& lhs, const ArenaAllocator<T2>& rhs) noexcept
+    {
+        return lhs.m_arena == rhs.m_arena;
+    }
+
+    template<typename T1, typename T2>
+    bool operator!=(const ArenaAllocator<T1>& lhs, const ArenaAllocator<T2>& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+}
@@ -2,14 +2,21 @@
 
 #include <atomic>
 #include <chrono>
-#if defined(__linux)
-#include <unistd.h>
-#include <linux/futex.h>
-#include <sys/syscall.h>
-#endif
+#include <cstdint>
+#include <algorithm>
+#include "Futex.h"
+#include "Cpu.h"
+#include "LockProfiler.h"
 #include "Exception.h"
 
 namespace core{
+    //Mutex is a futex based lock, all of its state resides within the object, making it usable in shared memory.
+    //a mutex which is never shared between processes should be constructed with Futex::Scope::PRIVATE, sparing
+    //the kernel the shared futex lookup upon contention.
+    //when built with CORE_LOCK_PROFILING each mutex is accounted by the LockProfiler under its construction site.
+    //in ADAPTIVE mode a contended lock spins (with cpu pause hints) before sleeping, the spin budget follows the
+    //spins recently needed to acquire the lock, and spinning is skipped altogether while the recent hold times are
+    //longer than a sleep round trip.
     class Mutex
     {
     private:
@@ -19,65 +26,182 @@ namespace core{
             LOCK_SINGLE,
             LOCK_MANY
         };
-    
-        typedef std::chrono::high_resolution_clock 	__clock_t;
-    
+
     public:
-        Mutex(): m_word(UNLOCK) {}
+        enum class Mode
+        {
+            BLOCKING,
+            ADAPTIVE
+        };
+
+        explicit Mutex(Mode mode = Mode::BLOCKING, Futex::Scope scope = Futex::Scope::SHARED, const LockSite& site = LockSite::Current())
+            : m_word(UNLOCK), m_adaptive(mode == Mode::ADAPTIVE), m_scope(scope), m_spinEstimate(0), m_holdEstimate(0), m_acquireTime(0)
+        #if defined(CORE_LOCK_PROFILING)
+            , m_probe(site.source)
+        #endif
+        {}
         
         void lock()
         {
             int lockState = UNLOCK;
-            if(std::atomic_compare_exchange_strong(&m_word, &lockState, static_cast<int>(LOCK_SINGLE)) == false)
+            if(std::atomic_compare_exchange_strong(&m_word, &lockState, static_cast<int>(LOCK_SINGLE)))
             {
+                OnAcquire(0);
+                return;
+            }
+            
+            std::int64_t waitStart = WaitStart();
+            if(m_adaptive == false || Spin() == false)
+            {
+                lockState = m_word.load();
                 if(lockState != LOCK_MANY)
                     lockState = std::atomic_exchange(&m_word, static_cast<int>(LOCK_MANY));
                 while(lockState != UNLOCK)
                 {
-
-                #if defined(__linux)
-                    syscall(SYS_futex, &m_word, FUTEX_WAIT, LOCK_MANY, nullptr, nullptr, 0);
-                #else
-                    throw Exception(__CORE_SOURCE, "wait is not being supported by current platform");
-                #endif
+                    Futex::Wait(&m_word, LOCK_MANY, m_scope);
                     lockState = std::atomic_exchange(&m_word, static_cast<int>(LOCK_MANY));
                 }
             }
+            OnAcquire(waitStart);
         }
     
         void unlock()
         {
+            OnRelease();
             if(std::atomic_fetch_sub(&m_word, 1) == LOCK_SINGLE)
                 return;
         
             m_word = UNLOCK;
-#if defined(__linux)
-            syscall(SYS_futex, &m_word, FUTEX_WAKE, 1, nullptr, nullptr, 0);
-#else
-            throw Exception(__CORE_SOURCE, "wake is not being supported by current platform");
-#endif
+            Futex::Wake(&m_word, 1, m_scope);
         }
     
         bool try_lock()
         {
             int lockState = UNLOCK;
-            return std::atomic_compare_exchange_strong(&m_word, &lockState, static_cast<int>(LOCK_SINGLE));
+            if(std::atomic_compare_exchange_strong(&m_word, &lockState, static_cast<int>(LOCK_SINGLE)) == false)
+                return false;
+            OnAcquire(0);
+            return true;
         }
         
         template<typename _Rep, typename _Period>
         bool try_lock_for(const std::chrono::duration<_Rep, _Period>& rtime)
         {
-            throw Exception(__CORE_SOURCE, "operation is not supported");
+            return try_lock_until(std::chrono::steady_clock::now() + rtime);
+        }
+    
+        //try_lock_until follows lock, only the futex wait is bounded by the deadline, upon expiration the word
+        //may remain LOCK_MANY, costing the owner a redundant wake.
+        template<typename _Clock, typename _Duration>
+        bool try_lock_until(const std::chrono::time_point<_Clock, _Duration>& atime)
+        {
+            int lockState = UNLOCK;
+            if(std::atomic_compare_exchange_strong(&m_word, &lockState, static_cast<int>(LOCK_SINGLE)))
+            {
+                OnAcquire(0);
+                return true;
+            }
+            
+            std::int64_t waitStart = WaitStart();
+            if(m_adaptive && Spin())
+            {
+                OnAcquire(waitStart);
+                return true;
+            }
+            
+            lockState = m_word.load();
+            if(lockState != LOCK_MANY)
+                lockState = std::atomic_exchange(&m_word, static_cast<int>(LOCK_MANY));
+            while(lockState != UNLOCK)
+            {
+                if(Futex::WaitUntil(&m_word, LOCK_MANY, atime, m_scope) == false)
+                    return false;
+                lockState = std::atomic_exchange(&m_word, static_cast<int>(LOCK_MANY));
+            }
+            OnAcquire(waitStart);
+            return true;
         }
     
-        template<typename _Duration>
-        bool try_lock_until(const std::chrono::time_point<__clock_t, _Duration>& atime)
+    private:
+        friend class Condition;
+        
+        //LockContended acquires the lock assuming others are waiting on it, used by waiters which were requeued
+        //onto the mutex word, so the mutex will keep waking them one by one upon unlock.
+        void LockContended()
         {
-            throw Exception(__CORE_SOURCE, "operation is not supported");
+            while(std::atomic_exchange(&m_word, static_cast<int>(LOCK_MANY)) != UNLOCK)
+                Futex::Wait(&m_word, LOCK_MANY, m_scope);
+            OnAcquire(0);
+        }
+        
+        static const int MaxSpinCount = 200;
+        static const std::uint32_t MaxSpinHoldCycles = 20000; //Roughly the cost of a futex sleep and wake up
+        
+        //Spin returns true if the lock was acquired while spinning.
+        bool Spin()
+        {
+            if(m_holdEstimate.load(std::memory_order_relaxed) > MaxSpinHoldCycles)
+                return false;
+            
+            int spinEstimate = m_spinEstimate.load(std::memory_order_relaxed);
+            int maxSpins = spinEstimate * 2 + 10 < MaxSpinCount ? spinEstimate * 2 + 10 : MaxSpinCount;
+            for(int spins = 0; spins < maxSpins; spins++)
+            {
+                int lockState = UNLOCK;
+                if(m_word.load(std::memory_order_relaxed) == UNLOCK &&
+                   std::atomic_compare_exchange_strong(&m_word, &lockState, static_cast<int>(LOCK_SINGLE)))
+                {
+                    m_spinEstimate.store(spinEstimate + (spins - spinEstimate) / 8, std::memory_order_relaxed);
+                    return true;
+                }
+                CpuRelax();
+            }
+            m_spinEstimate.store(spinEstimate + (maxSpins - spinEstimate) / 8, std::memory_order_relaxed);
+            return false;
+        }
+        
+        std::int64_t WaitStart()
+        {
+        #if defined(CORE_LOCK_PROFILING)
+            return LockProfiler::Now();
+        #else
+            return 0;
+        #endif
+        }
+        
+        //OnAcquire receives the time the acquirer started waiting, 0 if the lock was acquired right away.
+        void OnAcquire(std::int64_t waitStart)
+        {
+        #if defined(CORE_LOCK_PROFILING)
+            m_probe.OnAcquire(waitStart);
+        #endif
+            if(m_adaptive)
+                m_acquireTime = CpuCycles();
+        }
+        
+        void OnRelease()
+        {
+        #if defined(CORE_LOCK_PROFILING)
+            m_probe.OnRelease();
+        #endif
+            if(m_adaptive == false)
+                return;
+            std::uint64_t now = CpuCycles();
+            std::int64_t hold = now > m_acquireTime ? static_cast<std::int64_t>(std::min<std::uint64_t>(now - m_acquireTime, 1 << 30)) : 0;
+            std::int64_t holdEstimate = m_holdEstimate.load(std::memory_order_relaxed);
+            m_holdEstimate.store(static_cast<std::uint32_t>(holdEstimate + (hold - holdEstimate) / 8), std::memory_order_relaxed);
         }
     
     private:
        std::atomic<int> m_word;
+       const bool m_adaptive;
+       const Futex::Scope m_scope;
+       std::atomic<int> m_spinEstimate;
+       std::atomic<std::uint32_t> m_holdEstimate; //Moving average of hold times in cycles
+       std::uint64_t m_acquireTime; //Accessed by the owner only
+    #if defined(CORE_LOCK_PROFILING)
+       LockProbe m_probe;
+    #endif
     };
 }
 
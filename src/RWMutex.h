@@ -0,0 +1,189 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <limits>
+#include <functional>
+#include "Futex.h"
+#include "Cpu.h"
+
+namespace core{
+
+    //RWMutex is a futex based reader writer lock, all of its state resides within the object, making it usable in
+    //shared memory (unless constructed with Futex::Scope::PRIVATE). readers are counted within striped slots, each on its own
+    //cache line, a reader touches only the slot of its thread, the writer sums all slots. writers are preferred, a waiting writer blocks new readers.
+    //satisfies the SharedMutex concept, so std::shared_lock and std::unique_lock may be used.
+    class alignas(64) RWMutex
+    {
+    private:
+        enum Status : int
+        {
+            UNLOCK = 0,
+            LOCK_SINGLE, //A writer holds the lock or awaits the readers to drain
+            LOCK_MANY //As LOCK_SINGLE, and others sleep on the writer word
+        };
+
+    public:
+        static const int SlotsCount = 16;
+
+        explicit RWMutex(Futex::Scope scope = Futex::Scope::SHARED): m_writer(UNLOCK), m_drainSequence(0), m_scope(scope)
+        {
+            for(Slot& slot : m_slots)
+                slot.readers.store(0);
+        }
+        RWMutex(const RWMutex&) = delete;
+        RWMutex& operator=(const RWMutex&) = delete;
+
+        void lock()
+        {
+            int lockState = UNLOCK;
+            if(std::atomic_compare_exchange_strong(&m_writer, &lockState, static_cast<int>(LOCK_SINGLE)) == false)
+            {
+                if(lockState != LOCK_MANY)
+                    lockState = std::atomic_exchange(&m_writer, static_cast<int>(LOCK_MANY));
+                while(lockState != UNLOCK)
+                {
+                    Futex::Wait(&m_writer, LOCK_MANY, m_scope);
+                    lockState = std::atomic_exchange(&m_writer, static_cast<int>(LOCK_MANY));
+                }
+            }
+            WaitForReaders(0);
+        }
+
+        bool try_lock()
+        {
+            int lockState = UNLOCK;
+            if(std::atomic_compare_exchange_strong(&m_writer, &lockState, static_cast<int>(LOCK_SINGLE)) == false)
+                return false;
+            if(ReadersCount() != 0)
+            {
+                unlock();
+                return false;
+            }
+            return true;
+        }
+
+        void unlock()
+        {
+            if(std::atomic_exchange(&m_writer, static_cast<int>(UNLOCK)) == LOCK_MANY)
+                Futex::Wake(&m_writer, std::numeric_limits<int>::max(), m_scope);
+        }
+
+        void lock_shared()
+        {
+            std::atomic<int>& readers = m_slots[SlotIndex()].readers;
+            while(true)
+            {
+                int lockState = m_writer.load();
+                if(lockState == UNLOCK)
+                {
+                    readers++;
+                    if(m_writer.load() == UNLOCK)
+                        return;
+                    ReleaseSlot(readers);
+                    continue;
+                }
+                if(lockState == LOCK_MANY || std::atomic_compare_exchange_strong(&m_writer, &lockState, static_cast<int>(LOCK_MANY)))
+                    Futex::Wait(&m_writer, LOCK_MANY, m_scope);
+            }
+        }
+
+        bool try_lock_shared()
+        {
+            if(m_writer.load() != UNLOCK)
+                return false;
+            std::atomic<int>& readers = m_slots[SlotIndex()].readers;
+            readers++;
+            if(m_writer.load() == UNLOCK)
+                return true;
+            ReleaseSlot(readers);
+            return false;
+        }
+
+        void unlock_shared()
+        {
+            ReleaseSlot(m_slots[SlotIndex()].readers);
+        }
+
+        //upgrade turns a shared ownership into an exclusive one. the upgrade is atomic unless another writer holds
+        //or awaits the lock, in that case the shared ownership is released before locking (waiting for the other
+        //writer while holding it would deadlock) and false is returned, anything observed under the shared
+        //ownership must be revalidated.
+        bool upgrade()
+        {
+            int lockState = UNLOCK;
+            if(std::atomic_compare_exchange_strong(&m_writer, &lockState, static_cast<int>(LOCK_SINGLE)))
+            {
+                WaitForReaders(1);
+                m_slots[SlotIndex()].readers--;
+                return true;
+            }
+            unlock_shared();
+            lock();
+            return false;
+        }
+
+        //downgrade turns an exclusive ownership into a shared one, no other writer may interleave.
+        void downgrade()
+        {
+            m_slots[SlotIndex()].readers++;
+            unlock();
+        }
+
+    private:
+        struct alignas(64) Slot
+        {
+            std::atomic<int> readers;
+        };
+
+        //SlotIndex assigns each thread a fixed slot, a slot's count may be shared by several threads.
+        static std::size_t SlotIndex()
+        {
+            static thread_local std::size_t index = std::hash<std::thread::id>()(std::this_thread::get_id()) % SlotsCount;
+            return index;
+        }
+
+        int ReadersCount() const
+        {
+            int count = 0;
+            for(const Slot& slot : m_slots)
+                count += slot.readers.load();
+            return count;
+        }
+
+        //ReleaseSlot signals a draining writer, if any, the syscall is paid only while a writer is pending.
+        void ReleaseSlot(std::atomic<int>& readers)
+        {
+            readers--;
+            if(m_writer.load() != UNLOCK)
+            {
+                m_drainSequence++;
+                Futex::Wake(&m_drainSequence, 1, m_scope);
+            }
+        }
+
+        //WaitForReaders is called by the writer once it owns the writer word, new readers back off from now on.
+        void WaitForReaders(int expected)
+        {
+            const int spinCount = 100;
+            for(int spin = 0; ReadersCount() != expected; spin++)
+            {
+                if(spin < spinCount)
+                {
+                    CpuRelax();
+                    continue;
+                }
+                int sequence = m_drainSequence.load();
+                if(ReadersCount() == expected)
+                    break;
+                Futex::Wait(&m_drainSequence, sequence, m_scope);
+            }
+        }
+
+    private:
+        std::atomic<int> m_writer;
+        std::atomic<int> m_drainSequence;
+        const Futex::Scope m_scope;
+        Slot m_slots[SlotsCount];
+    };
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include "Futex.h"
+
+namespace core{
+
+    //Semaphore is a counting semaphore, all of its state resides within the object, making it usable in shared memory
+    //(unless constructed with Futex::Scope::PRIVATE). release pays a syscall only while acquirers sleep.
+    class Semaphore
+    {
+    public:
+        explicit Semaphore(int count, Futex::Scope scope = Futex::Scope::SHARED)
+            : m_count(count), m_waiters(0), m_scope(scope){}
+        Semaphore(const Semaphore&) = delete;
+        Semaphore& operator=(const Semaphore&) = delete;
+
+        void acquire()
+        {
+            while(try_acquire() == false)
+                Sleep([this]{ return Futex::Wait(&m_count, 0, m_scope); });
+        }
+
+        bool try_acquire()
+        {
+            int count = m_count.load(std::memory_order_relaxed);
+            while(count > 0)
+            {
+                if(m_count.compare_exchange_weak(count, count - 1, std::memory_order_acquire))
+                    return true;
+            }
+            return false;
+        }
+
+        template<typename Clock, typename Duration>
+        bool try_acquire_until(const std::chrono::time_point<Clock, Duration>& atime)
+        {
+            while(try_acquire() == false)
+            {
+                if(Sleep([this, &atime]{ return Futex::WaitUntil(&m_count, 0, atime, m_scope); }) == false)
+                    return try_acquire();
+            }
+            return true;
+        }
+
+        template<typename Rep, typename Period>
+        bool try_acquire_for(const std::chrono::duration<Rep, Period>& rtime)
+        {
+            return try_acquire_until(std::chrono::steady_clock::now() + rtime);
+        }
+
+        void release(int update = 1)
+        {
+            m_count.fetch_add(update, std::memory_order_seq_cst);
+            if(m_waiters.load(std::memory_order_seq_cst) != 0)
+                Futex::Wake(&m_count, update, m_scope);
+        }
+
+    private:
+        //Sleep waits while the count is zero, returns false only if the sleep has timed out.
+        template<typename Wait>
+        bool Sleep(const Wait& wait)
+        {
+            bool signaled = true;
+            m_waiters.fetch_add(1, std::memory_order_seq_cst);
+            if(m_count.load(std::memory_order_seq_cst) == 0)
+                signaled = wait();
+            m_waiters.fetch_sub(1, std::memory_order_relaxed);
+            return signaled;
+        }
+
+    private:
+        std::atomic<int> m_count;
+        std::atomic<int> m_waiters;
+        const Futex::Scope m_scope;
+    };
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <type_traits>
+#include "SharedObject.h"
+#include "Cpu.h"
+
+namespace core{
+
+    //SeqLock is a sequence lock, writers make the sequence odd for the duration of an update, readers never write,
+    //they read optimistically and retry if the sequence was odd or has changed meanwhile. all of its state resides
+    //within the object, making it usable in shared memory. writers are serialized by lock/unlock (kept short, they spin).
+    class SeqLock
+    {
+    public:
+        SeqLock(): m_sequence(0){}
+        SeqLock(const SeqLock&) = delete;
+        SeqLock& operator=(const SeqLock&) = delete;
+
+        void lock()
+        {
+            std::uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+            while((sequence & 1) || m_sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire) == false)
+            {
+                CpuRelax();
+                sequence = m_sequence.load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_release); //The odd sequence precedes the update
+        }
+
+        void unlock()
+        {
+            m_sequence.fetch_add(1, std::memory_order_release);
+        }
+
+        //read_begin returns the sequence to validate the read with, waiting for an ongoing update to complete.
+        std::uint64_t read_begin() const
+        {
+            std::uint64_t sequence;
+            while((sequence = m_sequence.load(std::memory_order_acquire)) & 1)
+                CpuRelax();
+            return sequence;
+        }
+
+        //read_retry returns true if the data read since read_begin may be torn.
+        bool read_retry(std::uint64_t sequence) const
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return m_sequence.load(std::memory_order_relaxed) != sequence;
+        }
+
+    private:
+        std::atomic<std::uint64_t> m_sequence;
+    };
+
+    //SharedSnapshot holds a single trivially copyable value guarded by a SeqLock, placed in shared memory, readers
+    //get a consistent copy without writing to shared memory, so any number of them may read concurrently.
+    template<typename Type>
+    class SharedSnapshot
+    {
+    public:
+        static_assert(std::is_trivially_copyable<Type>::value, "The value is copied while it may be updated, Type must be trivially copyable");
+        typedef Type value_type;
+        typedef SharedSnapshot<Type> _self;
+
+        SharedSnapshot(const std::string& name, bool owner, SharedObject::AccessMod mod, std::size_t offset = 0)
+            :m_sharedObject(new SharedObject(name, mod)), m_owner(owner)
+        {
+            std::size_t chunkSize = _self::chunk_size();
+            m_sharedObject->Allocate(chunkSize + offset);
+            m_region = m_sharedObject->Map(offset, chunkSize, mod);
+            Init(m_region.GetPtr());
+        }
+
+        SharedSnapshot(char* buffer, bool owner)
+            :m_owner(owner)
+        {
+            Init(buffer);
+        }
+
+        ~SharedSnapshot()
+        {
+            m_region.UnMap();
+            if(m_sharedObject && m_owner)
+                m_sharedObject->Unlink();
+        }
+
+        static constexpr std::size_t chunk_size()
+        {
+            return sizeof(Block);
+        }
+
+        void publish(const Type& value)
+        {
+            std::lock_guard<SeqLock> guard(m_block->lock);
+            m_block->value = value;
+        }
+
+        //update applies func to the value in place, func must be short as readers spin meanwhile.
+        template<typename Func>
+        void update(const Func& func)
+        {
+            std::lock_guard<SeqLock> guard(m_block->lock);
+            func(m_block->value);
+        }
+
+        //try_read makes a single attempt, returns false if it raced with an update.
+        bool try_read(Type& value) const
+        {
+            std::uint64_t sequence = m_block->lock.read_begin();
+            value = m_block->value;
+            return m_block->lock.read_retry(sequence) == false;
+        }
+
+        Type read() const
+        {
+            Type value;
+            while(try_read(value) == false);
+            return value;
+        }
+
+    private:
+        struct Block
+        {
+            SeqLock lock;
+            alignas(64) Type value;
+        };
+
+        void Init(char* buffer)
+        {
+            if(m_owner)
+                m_block = new(buffer)Block();
+            else
+                m_block = reinterpret_cast<Block*>(buffer);
+        }
+
+    private:
+        std::unique_ptr<SharedObject> m_sharedObject;
+        SharedRegion m_region;
+        Block* m_block;
+        bool m_owner;
+    };
+}
@@ -0,0 +1,417 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <new>
+#include <utility>
+#include <functional>
+#include "Allocator.h"
+#include "Assert.h"
+#include "NoExcept.h"
+
+namespace core
+{
+    //OffsetPtr is a self relative pointer, it stores the distance between its own address and the pointee,
+    //making it valid within a shared region regardless of the address the region is mapped at in each process.
+    //copying an OffsetPtr recalculates the distance relative to the new location.
+    template<typename T>
+    class OffsetPtr
+    {
+    public:
+        typedef T element_type;
+
+        OffsetPtr(): m_offset(NullOffset){}
+        OffsetPtr(T* ptr){ set(ptr); }
+        OffsetPtr(const OffsetPtr& object){ set(object.get()); }
+        OffsetPtr& operator=(const OffsetPtr& rhs){ set(rhs.get()); return *this; }
+        OffsetPtr& operator=(T* ptr){ set(ptr); return *this; }
+
+        T* get() const
+        {
+            return m_offset == NullOffset ? nullptr :
+                   reinterpret_cast<T*>(reinterpret_cast<std::intptr_t>(this) + m_offset);
+        }
+        T* operator->() const { return get(); }
+        T& operator*() const { return *get(); }
+        T& operator[](std::size_t idx) const { return get()[idx]; }
+        explicit operator bool() const { return m_offset != NullOffset; }
+
+    private:
+        void set(T* ptr)
+        {
+            m_offset = ptr == nullptr ? NullOffset :
+                       reinterpret_cast<std::intptr_t>(ptr) - reinterpret_cast<std::intptr_t>(this);
+        }
+
+    private:
+        static const std::intptr_t NullOffset = 1; //Can't be a legit distance, it points into the OffsetPtr itself
+        std::intptr_t m_offset;
+    };
+
+    //Shared containers are designed to be placed within a region managed by a BuddySharedAllocator, they hold no
+    //allocator (an allocator is a process local object) instead every mutating operation receives one, while read
+    //operations need nothing but the mapped region. memory is returned explicitly by release, nested containers
+    //(e.g a SharedString value) need to be released by their owner before the enclosing container is released.
+    //containers are not synchronized, the common use is a single builder and many readers afterwards.
+    template<typename T>
+    class SharedVector
+    {
+    public:
+        typedef T value_type;
+        typedef std::size_t size_type;
+        typedef T* iterator;
+        typedef const T* const_iterator;
+
+        SharedVector(): m_size(0), m_capacity(0){}
+        SharedVector(const SharedVector&) = delete;
+        SharedVector& operator=(const SharedVector&) = delete;
+        SharedVector(SharedVector&& object) NOEXCEPT(true)
+            :m_data(object.m_data), m_size(object.m_size), m_capacity(object.m_capacity)
+        {
+            object.m_data = nullptr;
+            object.m_size = object.m_capacity = 0;
+        }
+
+        void reserve(size_type capacity, Allocator<char>& allocator)
+        {
+            if(capacity <= m_capacity)
+                return;
+            T* data = reinterpret_cast<T*>(allocator.allocate(capacity * sizeof(T)));
+            T* oldData = m_data.get();
+            for(size_type idx = 0; idx < m_size; idx++)
+            {
+                new(data + idx)T(std::move(oldData[idx]));
+                oldData[idx].~T();
+            }
+            if(oldData != nullptr)
+                allocator.deallocate(oldData);
+            m_data = data;
+            m_capacity = capacity;
+        }
+
+        void push_back(const T& value, Allocator<char>& allocator)
+        {
+            emplace_back(allocator, value);
+        }
+
+        template<typename... Args>
+        T& emplace_back(Allocator<char>& allocator, Args&&... args)
+        {
+            if(m_size == m_capacity)
+                reserve(m_capacity == 0 ? 8 : m_capacity * 2, allocator);
+            T* element = new(m_data.get() + m_size)T(std::forward<Args>(args)...);
+            m_size++;
+            return *element;
+        }
+
+        void pop_back()
+        {
+            VERIFY(m_size > 0, "pop_back was called on an empty vector");
+            m_data[--m_size].~T();
+        }
+
+        void clear()
+        {
+            for(size_type idx = 0; idx < m_size; idx++)
+                m_data[idx].~T();
+            m_size = 0;
+        }
+
+        void release(Allocator<char>& allocator)
+        {
+            clear();
+            if(m_data)
+                allocator.deallocate(m_data.get());
+            m_data = nullptr;
+            m_capacity = 0;
+        }
+
+        size_type size() const { return m_size; }
+        size_type capacity() const { return m_capacity; }
+        bool empty() const { return m_size == 0; }
+        T* data() { return m_data.get(); }
+        const T* data() const { return m_data.get(); }
+        T& operator[](size_type idx) { return m_data[idx]; }
+        const T& operator[](size_type idx) const { return m_data[idx]; }
+        T& at(size_type idx)
+        {
+            VERIFY(idx < m_size, "index %lu is out of range, size - %lu", idx, m_size);
+            return m_data[idx];
+        }
+        const T& at(size_type idx) const
+        {
+            VERIFY(idx < m_size, "index %lu is out of range, size - %lu", idx, m_size);
+            return m_data[idx];
+        }
+        iterator begin() { return m_data.get(); }
+        iterator end() { return m_data.get() + m_size; }
+        const_iterator begin() const { return m_data.get(); }
+        const_iterator end() const { return m_data.get() + m_size; }
+
+    private:
+        OffsetPtr<T> m_data;
+        size_type m_size;
+        size_type m_capacity;
+    };
+
+    //SharedString is an immutable, null terminated, string stored in a shared region.
+    class SharedString
+    {
+    public:
+        typedef std::size_t size_type;
+
+        SharedString(): m_size(0){}
+        SharedString(const char* str, Allocator<char>& allocator): m_size(0){ assign(str, strlen(str), allocator); }
+        SharedString(const std::string& str, Allocator<char>& allocator): m_size(0){ assign(str.c_str(), str.size(), allocator); }
+
+        void assign(const char* str, size_type size, Allocator<char>& allocator)
+        {
+            release(allocator);
+            char* data = allocator.allocate(size + 1);
+            memcpy(data, str, size);
+            data[size] = '\0';
+            m_data = data;
+            m_size = size;
+        }
+
+        void release(Allocator<char>& allocator)
+        {
+            if(m_data)
+                allocator.deallocate(m_data.get());
+            m_data = nullptr;
+            m_size = 0;
+        }
+
+        const char* c_str() const { return m_data ? m_data.get() : ""; }
+        const char* data() const { return c_str(); }
+        size_type size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        std::string str() const { return std::string(c_str(), m_size); }
+
+        bool equals(const char* str, size_type size) const
+        {
+            return m_size == size && memcmp(c_str(), str, size) == 0;
+        }
+
+    private:
+        OffsetPtr<char> m_data;
+        size_type m_size;
+    };
+
+    inline bool operator==(const SharedString& lhs, const SharedString& rhs) { return lhs.equals(rhs.c_str(), rhs.size()); }
+    inline bool operator==(const SharedString& lhs, const std::string& rhs) { return lhs.equals(rhs.c_str(), rhs.size()); }
+    inline bool operator==(const SharedString& lhs, const char* rhs) { return lhs.equals(rhs, strlen(rhs)); }
+    inline bool operator!=(const SharedString& lhs, const SharedString& rhs) { return !(lhs == rhs); }
+    inline bool operator!=(const SharedString& lhs, const std::string& rhs) { return !(lhs == rhs); }
+    inline bool operator!=(const SharedString& lhs, const char* rhs) { return !(lhs == rhs); }
+
+    //SharedHash must produce the same value in every process, std::hash is used for non string keys.
+    template<typename Key>
+    struct SharedHash
+    {
+        std::size_t operator()(const Key& key) const { return std::hash<Key>()(key); }
+    };
+
+    template<>
+    struct SharedHash<SharedString>
+    {
+        static std::size_t Hash(const char* str, std::size_t size) //FNV-1a
+        {
+            std::uint64_t hash = 14695981039346656037ULL;
+            for(std::size_t idx = 0; idx < size; idx++)
+            {
+                hash ^= static_cast<unsigned char>(str[idx]);
+                hash *= 1099511628211ULL;
+            }
+            return static_cast<std::size_t>(hash);
+        }
+        std::size_t operator()(const SharedString& key) const { return Hash(key.c_str(), key.size()); }
+        std::size_t operator()(const std::string& key) const { return Hash(key.c_str(), key.size()); }
+        std::size_t operator()(const char* key) const { return Hash(key, strlen(key)); }
+    };
+
+    //SharedHashMap is an open addressing (linear probing) hash map, lookups are heterogeneous, a map keyed
+    //by SharedString can be queried with a std::string or a c-type string.
+    template<typename Key, typename Value, typename Hash = SharedHash<Key>>
+    class SharedHashMap
+    {
+    private:
+        enum SlotState : char
+        {
+            Empty = 0,
+            Occupied,
+            Deleted
+        };
+
+        struct Slot
+        {
+            SlotState state;
+            Key key;
+            Value value;
+        };
+
+    public:
+        typedef Key key_type;
+        typedef Value mapped_type;
+        typedef std::size_t size_type;
+
+        SharedHashMap(): m_size(0), m_used(0), m_capacity(0){}
+        SharedHashMap(const SharedHashMap&) = delete;
+        SharedHashMap& operator=(const SharedHashMap&) = delete;
+
+        //insert will not overwrite an existing key, returning false in such a case.
+        template<typename V>
+        bool insert(const Key& key, V&& value, Allocator<char>& allocator)
+        {
+            if((m_used + 1) * 4 > m_capacity * 3)
+                rehash(m_capacity == 0 ? 16 : (m_size + 1) * 2 > m_capacity ? m_capacity * 2 : m_capacity, allocator);
+
+            size_type mask = m_capacity - 1;
+            size_type idx = Hash()(key) & mask;
+            Slot* slots = m_slots.get();
+            Slot* target = nullptr;
+            for(;; idx = (idx + 1) & mask)
+            {
+                Slot& slot = slots[idx];
+                if(slot.state == Empty)
+                {
+                    if(target == nullptr)
+                    {
+                        target = &slot;
+                        m_used++;
+                    }
+                    break;
+                }
+                if(slot.state == Deleted)
+                {
+                    if(target == nullptr)
+                        target = &slot;
+                }
+                else if(slot.key == key)
+                    return false;
+            }
+            new(&target->key)Key(key);
+            new(&target->value)Value(std::forward<V>(value));
+            target->state = Occupied;
+            m_size++;
+            return true;
+        }
+
+        template<typename K>
+        const Value* find(const K& key) const
+        {
+            const Slot* slot = find_slot(key);
+            return slot == nullptr ? nullptr : &slot->value;
+        }
+
+        template<typename K>
+        Value* find(const K& key)
+        {
+            const Slot* slot = find_slot(key);
+            return slot == nullptr ? nullptr : const_cast<Value*>(&slot->value);
+        }
+
+        template<typename K>
+        bool contains(const K& key) const { return find_slot(key) != nullptr; }
+
+        template<typename K>
+        bool erase(const K& key)
+        {
+            Slot* slot = const_cast<Slot*>(find_slot(key));
+            if(slot == nullptr)
+                return false;
+            slot->key.~Key();
+            slot->value.~Value();
+            slot->state = Deleted;
+            m_size--;
+            return true;
+        }
+
+        template<typename Visitor>
+        void for_each(const Visitor& visitor) const
+        {
+            const Slot* slots = m_slots.get();
+            for(size_type idx = 0; idx < m_capacity; idx++)
+            {
+                if(slots[idx].state == Occupied)
+                    visitor(slots[idx].key, slots[idx].value);
+            }
+        }
+
+        void release(Allocator<char>& allocator)
+        {
+            Slot* slots = m_slots.get();
+            for(size_type idx = 0; idx < m_capacity; idx++)
+            {
+                if(slots[idx].state == Occupied)
+                {
+                    slots[idx].key.~Key();
+                    slots[idx].value.~Value();
+                }
+            }
+            if(slots != nullptr)
+                allocator.deallocate(slots);
+            m_slots = nullptr;
+            m_size = m_used = m_capacity = 0;
+        }
+
+        size_type size() const { return m_size; }
+        size_type capacity() const { return m_capacity; }
+        bool empty() const { return m_size == 0; }
+
+    private:
+        template<typename K>
+        const Slot* find_slot(const K& key) const
+        {
+            if(m_size == 0)
+                return nullptr;
+            size_type mask = m_capacity - 1;
+            const Slot* slots = m_slots.get();
+            for(size_type idx = Hash()(key) & mask;; idx = (idx + 1) & mask)
+            {
+                const Slot& slot = slots[idx];
+                if(slot.state == Empty)
+                    return nullptr;
+                if(slot.state == Occupied && slot.key == key)
+                    return &slot;
+            }
+        }
+
+        void rehash(size_type capacity, Allocator<char>& allocator)
+        {
+            Slot* slots = reinterpret_cast<Slot*>(allocator.allocate(capacity * sizeof(Slot)));
+            for(size_type idx = 0; idx < capacity; idx++)
+                slots[idx].state = Empty;
+
+            Slot* oldSlots = m_slots.get();
+            size_type mask = capacity - 1;
+            for(size_type oldIdx = 0; oldIdx < m_capacity; oldIdx++)
+            {
+                Slot& oldSlot = oldSlots[oldIdx];
+                if(oldSlot.state != Occupied)
+                    continue;
+                size_type idx = Hash()(oldSlot.key) & mask;
+                while(slots[idx].state == Occupied)
+                    idx = (idx + 1) & mask;
+                new(&slots[idx].key)Key(std::move(oldSlot.key));
+                new(&slots[idx].value)Value(std::move(oldSlot.value));
+                slots[idx].state = Occupied;
+                oldSlot.key.~Key();
+                oldSlot.value.~Value();
+            }
+            if(oldSlots != nullptr)
+                allocator.deallocate(oldSlots);
+            m_slots = slots;
+            m_capacity = capacity;
+            m_used = m_size;
+        }
+
+    private:
+        OffsetPtr<Slot> m_slots;
+        size_type m_size;
+        size_type m_used; //Occupied and deleted slots
+        size_type m_capacity; //Always a power of 2
+    };
+}
@@ -5,6 +5,8 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/memfd.h>
 #include <asm-generic/errno-base.h>
 #include <errno.h>
 #endif
@@ -14,10 +16,48 @@
 
 namespace core{
     
+    namespace
+    {
+        #if defined(__linux)
+        SharedRegion MapHandle(int handle, size_t offset, size_t pageOffset, size_t size, SharedObject::AccessMod mod)
+        {
+            int prot = 0;
+            switch(mod)
+            {
+                case SharedObject::AccessMod::READ:
+                    prot = PROT_READ;
+                    break;
+                case SharedObject::AccessMod::READ_WRITE:
+                    prot = (PROT_READ | PROT_WRITE);
+                    break;
+                default:
+                    throw Exception(__CORE_SOURCE, "Non supported mod");
+            }
+            
+            void* base = ::mmap(NULL, pageOffset + size, prot, MAP_SHARED, handle, static_cast<off_t>(offset - pageOffset));
+            PLATFORM_VERIFY(base != (void*)-1);
+            return SharedRegion(base, pageOffset, size);
+        }
+        
+        int OpenFlag(SharedObject::AccessMod mod)
+        {
+            switch(mod)
+            {
+                case SharedObject::AccessMod::READ:
+                    return O_RDONLY;
+                case SharedObject::AccessMod::READ_WRITE:
+                    return O_RDWR;
+                default:
+                    throw Exception(__CORE_SOURCE, "Non supported mod");
+            }
+        }
+        #endif
+    }
+    
     SharedRegion::SharedRegion()
         :m_base(nullptr), m_ptr(nullptr), m_size(0), m_mapped(false){}
     
-    SharedRegion::SharedRegion(void *base, int pageOffset, size_t size)
+    SharedRegion::SharedRegion(void *base, size_t pageOffset, size_t size)
         :m_base(base), m_ptr(reinterpret_cast<char*>(base) + pageOffset), m_size(size), m_mapped(true){}
     
     SharedRegion::SharedRegion(const SharedRegion& object)
@@ -46,6 +86,70 @@ namespace core{
         }
     }
     
+    void SharedRegion::Advise(Advice advice)
+    {
+        Advise(advice, 0, m_size);
+    }
+    
+    void SharedRegion::Advise(Advice advice, size_t offset, size_t size)
+    {
+        #if defined(__linux)
+        VERIFY(m_mapped, "Region is not mapped");
+        VERIFY(offset + size <= m_size, "Range exceeds the region size");
+        int flag = 0;
+        switch(advice)
+        {
+            case Advice::NORMAL:
+                flag = MADV_NORMAL;
+                break;
+            case Advice::SEQUENTIAL:
+                flag = MADV_SEQUENTIAL;
+                break;
+            case Advice::RANDOM:
+                flag = MADV_RANDOM;
+                break;
+            case Advice::WILL_NEED:
+                flag = MADV_WILLNEED;
+                break;
+            case Advice::DONT_NEED:
+                flag = MADV_DONTNEED;
+                break;
+            default:
+                throw Exception(__CORE_SOURCE, "Non supported advice");
+        }
+        std::pair<void*, size_t> range = PageAlignedRange(offset, size);
+        PLATFORM_VERIFY(::madvise(range.first, range.second, flag) == 0);
+        #endif
+    }
+    
+    void SharedRegion::Sync(bool async)
+    {
+        Sync(0, m_size, async);
+    }
+    
+    void SharedRegion::Sync(size_t offset, size_t size, bool async)
+    {
+        #if defined(__linux)
+        VERIFY(m_mapped, "Region is not mapped");
+        VERIFY(offset + size <= m_size, "Range exceeds the region size");
+        std::pair<void*, size_t> range = PageAlignedRange(offset, size);
+        PLATFORM_VERIFY(::msync(range.first, range.second, async ? MS_ASYNC : MS_SYNC) == 0);
+        #endif
+    }
+    
+    std::pair<void*, size_t> SharedRegion::PageAlignedRange(size_t offset, size_t size) const
+    {
+        //m_base is page aligned, madvise and msync require a page aligned start address
+        #if defined(__linux)
+        size_t pageSize = sysconf(_SC_PAGESIZE);
+        #else
+        size_t pageSize = 1;
+        #endif
+        size_t start = (m_ptr - reinterpret_cast<char*>(m_base)) + offset;
+        size_t alignedStart = start - start % pageSize;
+        return std::make_pair(reinterpret_cast<char*>(m_base) + alignedStart, size + (start - alignedStart));
+    }
+    
     SharedObject::SharedObject(const std::string &name, AccessMod mod)
     #if defined(__linux)
         :m_pageSize(sysconf(_SC_PAGESIZE)), m_handle(-1)
@@ -56,18 +160,7 @@ namespace core{
     {
         #if defined(__linux)
         m_name = AddLeadingSlash(name);
-        int flag = 0;
-        switch(mod)
-        {
-            case AccessMod::READ:
-                flag = O_RDONLY;
-                break;
-            case AccessMod::READ_WRITE:
-                flag = O_RDWR;
-                break;
-            default:
-                throw Exception(__CORE_SOURCE, "Non supported mod");
-        }
+        int flag = OpenFlag(mod);
         mode_t permission = (Directory::READ_WRITE_ONLY<<6) | (Directory::READ_ONLY<<3) |(Directory::READ_ONLY);
         m_handle = shm_open(m_name.c_str(), flag | (O_CREAT | O_EXCL), permission);
         if(m_handle >= 0)
@@ -110,25 +203,9 @@ namespace core{
     SharedRegion SharedObject::Map(int offset, size_t size, AccessMod mod)
     {
         #if defined(__linux)
-        int pageOffset = CorrectedPageOffset(offset);
-        int prot = 0;
-        switch(mod)
-        {
-            case AccessMod::READ:
-                prot = PROT_READ;
-                break;
-            case AccessMod::READ_WRITE:
-                prot = (PROT_READ | PROT_WRITE);
-                break;
-            default:
-                throw Exception(__CORE_SOURCE, "Non supported mod");
-        }
-    
-        void* base = ::mmap(NULL, static_cast<std::size_t>(pageOffset + size), prot, MAP_SHARED, m_handle, offset - pageOffset);
-        PLATFORM_VERIFY(base != (void*)-1);
-        return SharedRegion(base, pageOffset, size);
+        return MapHandle(m_handle, offset, CorrectedPageOffset(offset), size, mod);
         #else
-        return SharedRegion(nullptr, -1, -1);
+        return SharedRegion(); //Unmapped
         #endif
     }
     
@@ -149,4 +226,139 @@ namespace core{
     {
         return offset % m_pageSize;
     }
+    
+    MappedFile::MappedFile(const std::string& path, SharedObject::AccessMod mod, bool create)
+    #if defined(__linux)
+        :m_pageSize(sysconf(_SC_PAGESIZE)), m_handle(-1), m_path(path)
+    #else
+        :m_pageSize(0), m_handle(-1), m_path(path)
+    #endif
+    {
+        #if defined(__linux)
+        mode_t permission = (Directory::READ_WRITE_ONLY<<6) | (Directory::READ_ONLY<<3) |(Directory::READ_ONLY);
+        m_handle = ::open(m_path.c_str(), OpenFlag(mod) | (create ? O_CREAT : 0), permission);
+        PLATFORM_VERIFY(m_handle >= 0);
+        #else
+        throw Exception(__CORE_SOURCE, "MappedFile is only supported in linux platform");
+        #endif
+    }
+    
+    MappedFile::~MappedFile()
+    {
+        #if defined(__linux)
+        if(m_handle >= 0)
+            ::close(m_handle); //Existing mappings remain valid
+        #endif
+    }
+    
+    void MappedFile::Allocate(size_t size)
+    {
+        #if defined(__linux)
+        PLATFORM_VERIFY(::ftruncate(m_handle, size) == 0);
+        #endif
+    }
+    
+    size_t MappedFile::GetSize() const
+    {
+        #if defined(__linux)
+        struct stat fileStat;
+        PLATFORM_VERIFY(::fstat(m_handle, &fileStat) == 0);
+        return static_cast<size_t>(fileStat.st_size);
+        #else
+        return 0;
+        #endif
+    }
+    
+    SharedRegion MappedFile::Map(size_t offset, size_t size, SharedObject::AccessMod mod)
+    {
+        #if defined(__linux)
+        return MapHandle(m_handle, offset, offset % m_pageSize, size, mod);
+        #else
+        return SharedRegion(); //Unmapped
+        #endif
+    }
+    
+    AnonymousSharedObject::AnonymousSharedObject(const std::string& debugName, bool allowSealing)
+    #if defined(__linux)
+        :m_pageSize(sysconf(_SC_PAGESIZE)), m_handle(-1)
+    #else
+        :m_pageSize(0), m_handle(-1)
+    #endif
+    {
+        #if defined(__linux)
+        m_handle = static_cast<int>(::syscall(SYS_memfd_create, debugName.c_str(), MFD_CLOEXEC | (allowSealing ? MFD_ALLOW_SEALING : 0)));
+        PLATFORM_VERIFY(m_handle >= 0);
+        #else
+        throw Exception(__CORE_SOURCE, "AnonymousSharedObject is only supported in linux platform");
+        #endif
+    }
+    
+    AnonymousSharedObject::AnonymousSharedObject(int handle)
+    #if defined(__linux)
+        :m_pageSize(sysconf(_SC_PAGESIZE)), m_handle(handle)
+    #else
+        :m_pageSize(0), m_handle(handle)
+    #endif
+    {
+        VERIFY(m_handle >= 0, "Invalid handle was provided");
+    }
+    
+    AnonymousSharedObject::AnonymousSharedObject(AnonymousSharedObject&& object)
+        :m_pageSize(object.m_pageSize), m_handle(object.m_handle)
+    {
+        object.m_handle = -1;
+    }
+    
+    AnonymousSharedObject::~AnonymousSharedObject()
+    {
+        #if defined(__linux)
+        if(m_handle >= 0)
+            ::close(m_handle); //Existing mappings keep the object alive
+        #endif
+    }
+    
+    void AnonymousSharedObject::Allocate(size_t size)
+    {
+        #if defined(__linux)
+        PLATFORM_VERIFY(::ftruncate(m_handle, size) == 0);
+        #endif
+    }
+    
+    size_t AnonymousSharedObject::GetSize() const
+    {
+        #if defined(__linux)
+        struct stat objectStat;
+        PLATFORM_VERIFY(::fstat(m_handle, &objectStat) == 0);
+        return static_cast<size_t>(objectStat.st_size);
+        #else
+        return 0;
+        #endif
+    }
+    
+    SharedRegion AnonymousSharedObject::Map(size_t offset, size_t size, SharedObject::AccessMod mod)
+    {
+        #if defined(__linux)
+        return MapHandle(m_handle, offset, offset % m_pageSize, size, mod);
+        #else
+        return SharedRegion(); //Unmapped
+        #endif
+    }
+    
+    void AnonymousSharedObject::AddSeals(int seals)
+    {
+        #if defined(__linux)
+        PLATFORM_VERIFY(::fcntl(m_handle, F_ADD_SEALS, seals) == 0);
+        #endif
+    }
+    
+    int AnonymousSharedObject::GetSeals() const
+    {
+        #if defined(__linux)
+        int seals = ::fcntl(m_handle, F_GET_SEALS);
+        PLATFORM_VERIFY(seals != -1);
+        return seals;
+        #else
+        return 0;
+        #endif
+    }
 }
@@ -1,19 +1,38 @@
 #pragma once
 
 #include <string>
+#include <utility>
 
 namespace core
 {
     class SharedRegion
     {
     public:
+        enum class Advice
+        {
+            NORMAL,
+            SEQUENTIAL,
+            RANDOM,
+            WILL_NEED,
+            DONT_NEED
+        };
+        
         SharedRegion();
-        SharedRegion(void* base, int pageOffset, size_t size);
+        SharedRegion(void* base, size_t pageOffset, size_t size);
         SharedRegion(const SharedRegion& object);
         SharedRegion& operator=(const SharedRegion& rhs);
         char* GetPtr();
         size_t GetSize() const;
         void UnMap();
+        //Advise hints the kernel regarding the expected access pattern of [offset, offset + size) within the region.
+        void Advise(Advice advice);
+        void Advise(Advice advice, size_t offset, size_t size);
+        //Sync flushes dirty pages of [offset, offset + size) into the backing object, an async sync only schedules the write back.
+        void Sync(bool async = true);
+        void Sync(size_t offset, size_t size, bool async = true);
+        
+    private:
+        std::pair<void*, size_t> PageAlignedRange(size_t offset, size_t size) const;
         
     private:
         void* m_base;
@@ -43,4 +62,57 @@ namespace core
         int m_handle;
         std::string m_name;
     };
-}
\ No newline at end of file
+    
+    //MappedFile is the file backed counterpart of SharedObject, regular files are mapped (lazily paged in by the kernel)
+    //through the same Allocate/Map API, a file is not removed upon destruction and its content survives a reboot.
+    class MappedFile
+    {
+    public:
+        MappedFile(const std::string& path, SharedObject::AccessMod mod, bool create = false);
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        void Allocate(size_t size);
+        size_t GetSize() const;
+        //offset is a byte offset within the file, not limited to 2GB, a large file may be mapped piece by piece.
+        SharedRegion Map(size_t offset, size_t size, SharedObject::AccessMod mode);
+        
+    private:
+        const size_t m_pageSize;
+        int m_handle;
+        std::string m_path;
+    };
+    
+    //AnonymousSharedObject is a nameless shared object (memfd), it leaves nothing behind in /dev/shm and is released
+    //once the last descriptor and mapping are closed. the object is shared by passing its handle, to a forked child
+    //or to an unrelated process via UnixSocket::SendDescriptor, the receiver adopts the handle through the handle constructor.
+    class AnonymousSharedObject
+    {
+    public:
+        enum Seal : int
+        {
+            SEAL_SEAL = 0x1, //No further seals may be added
+            SEAL_SHRINK = 0x2,
+            SEAL_GROW = 0x4,
+            SEAL_WRITE = 0x8
+        };
+        
+        explicit AnonymousSharedObject(const std::string& debugName, bool allowSealing = true);
+        explicit AnonymousSharedObject(int handle);
+        ~AnonymousSharedObject();
+        AnonymousSharedObject(AnonymousSharedObject&& object);
+        AnonymousSharedObject(const AnonymousSharedObject&) = delete;
+        AnonymousSharedObject& operator=(const AnonymousSharedObject&) = delete;
+        void Allocate(size_t size);
+        size_t GetSize() const;
+        SharedRegion Map(size_t offset, size_t size, SharedObject::AccessMod mode);
+        //AddSeals receives a combination of Seal values, seals are irreversible and apply to all holders of the object.
+        void AddSeals(int seals);
+        int GetSeals() const;
+        int GetHandle() const { return m_handle; }
+        
+    private:
+        size_t m_pageSize;
+        int m_handle;
+    };
+}
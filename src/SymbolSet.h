@@ -1,137 +1,253 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include "Assert.h"
 
 namespace core{
 
 #define BYTE_BIT_COUNT 8
-    
+#define WORD_BIT_COUNT 64
+
+    namespace symbol_detail
+    {
+        inline int PopCount(std::uint64_t word)
+        {
+        #if defined(__GNUC__)
+            return __builtin_popcountll(word);
+        #else
+            int count = 0;
+            for(; word; word &= word - 1)
+                count++;
+            return count;
+        #endif
+        }
+
+        inline int TrailingZeros(std::uint64_t word) //word must not be 0
+        {
+        #if defined(__GNUC__)
+            return __builtin_ctzll(word);
+        #else
+            int count = 0;
+            for(; (word & 0x1) == 0; word >>= 1)
+                count++;
+            return count;
+        #endif
+        }
+    }
+
+    //Symbol is a view of SymbolSize bits starting at bit firstByteOffset of symbolBuffer, the symbol is read and
+    //written as a single masked little endian word, the buffer must be accessible for sizeof(uint64_t) + 1 bytes
+    //starting at symbolBuffer (Symbolset pads its buffer accordingly).
     template<std::size_t SymbolSize>
     class Symbol
     {
     public:
+        static constexpr std::uint64_t SymbolMask = SymbolSize == WORD_BIT_COUNT ? ~static_cast<std::uint64_t>(0) :
+                                                    (static_cast<std::uint64_t>(1) << SymbolSize) - 1;
+
         Symbol(char* const symbolBuffer, int firstByteOffset)
             :m_buffer(symbolBuffer), m_firstByteOffset(firstByteOffset)
         {
-            m_byteCount = SymbolSize % BYTE_BIT_COUNT == 0 ? SymbolSize / BYTE_BIT_COUNT : SymbolSize / BYTE_BIT_COUNT + 1;
-            m_byteCount += m_firstByteOffset + SymbolSize > BYTE_BIT_COUNT && //Does the symbol crosses the first byte?
-                    (m_firstByteOffset + SymbolSize) % BYTE_BIT_COUNT != 0 ? 1 : 0; //Symbol crosses byte boundaries at the last byte?
             static_assert((sizeof(long) * BYTE_BIT_COUNT) >= SymbolSize, "Symbol size is too large");
         }
-        
+
         void operator = (long value)
         {
-            int bitOffset = 0;
-            char* valueByte = reinterpret_cast<char*>(&value);
-            for(int byteIdx = 0; byteIdx < m_byteCount; byteIdx++)
+            std::uint64_t bits = static_cast<std::uint64_t>(value) & SymbolMask;
+            std::uint64_t word;
+            memcpy(&word, m_buffer, sizeof(word));
+            word = (word & ~(SymbolMask << m_firstByteOffset)) | (bits << m_firstByteOffset);
+            memcpy(m_buffer, &word, sizeof(word));
+            if(m_firstByteOffset + SymbolSize > WORD_BIT_COUNT) //The symbol crosses into the 9th byte
             {
-                int byteOffset = byteIdx == 0 ? m_firstByteOffset : 0;
-                int currentByteBitCount = byteIdx == 0 ? BYTE_BIT_COUNT - m_firstByteOffset : std::min(BYTE_BIT_COUNT, ((int)SymbolSize) - bitOffset);
-                valueByte += (bitOffset / BYTE_BIT_COUNT);
-                char* currentByte = m_buffer + byteIdx;
-                for(int byteBitIdx = 0; byteBitIdx < currentByteBitCount; byteBitIdx++)
-                {
-                    char byte = *valueByte & (0x1 << (bitOffset % BYTE_BIT_COUNT));
-                    if(byte)
-                        *currentByte = *currentByte | 0x1 << (byteBitIdx + byteOffset) ;
-                    else
-                        *currentByte = *currentByte & ~(0x1 << (byteBitIdx + byteOffset));
-                    bitOffset++;
-                    if(bitOffset == SymbolSize)
-                        break;
-                }
+                unsigned char highMask = static_cast<unsigned char>((1 << (m_firstByteOffset + SymbolSize - WORD_BIT_COUNT)) - 1);
+                unsigned char highBits = static_cast<unsigned char>(bits >> (WORD_BIT_COUNT - m_firstByteOffset));
+                m_buffer[sizeof(word)] = static_cast<char>((m_buffer[sizeof(word)] & ~highMask) | (highBits & highMask));
             }
         }
-        
+
         operator long()
         {
             VERIFY(sizeof(long) >= SymbolSize / BYTE_BIT_COUNT, "long is not large enough to support the symbol");
             return ToIntegralType<long>();
         }
-    
+
         operator int()
         {
             VERIFY(sizeof(int) >= SymbolSize / BYTE_BIT_COUNT, "int is not large enough to support the symbol");
             return ToIntegralType<int>();
         }
-        
+
         operator short()
         {
             VERIFY(sizeof(short) >= SymbolSize / BYTE_BIT_COUNT, "short is not large enough to support the symbol");
             return ToIntegralType<short>();
         }
-    
+
         operator char()
         {
             VERIFY(sizeof(char) >= SymbolSize * BYTE_BIT_COUNT, "char is not large enough to support the symbol");
             return ToIntegralType<char>();
         }
-    
+
         template<typename IntegralType>
         IntegralType ToIntegralType()
         {
-    
-            IntegralType result = 0;
-            int bitOffset = 0;
-            char* resultByte = reinterpret_cast<char*>(&result);
-            for(int byteIdx = 0; byteIdx < m_byteCount; byteIdx++)
-            {
-                int byteOffset = byteIdx == 0 ? m_firstByteOffset : 0;
-                int currentByteBitCount = byteIdx == 0 ? BYTE_BIT_COUNT - m_firstByteOffset : std::min(BYTE_BIT_COUNT, ((int)SymbolSize) - bitOffset);
-                resultByte += (bitOffset / BYTE_BIT_COUNT);
-                char bufferByte = *(m_buffer + byteIdx);
-                for(int byteBitIdx = 0; byteBitIdx < currentByteBitCount; byteBitIdx++)
-                {
-                    *resultByte = *resultByte | ((bufferByte & (0x1 << (byteOffset + byteBitIdx))) >> (byteOffset + byteBitIdx) << (bitOffset % BYTE_BIT_COUNT));
-                    bitOffset++;
-                    if(bitOffset == SymbolSize)
-                        break;
-                }
-            }
-            return result;
+            std::uint64_t word;
+            memcpy(&word, m_buffer, sizeof(word));
+            std::uint64_t bits = word >> m_firstByteOffset;
+            if(m_firstByteOffset + SymbolSize > WORD_BIT_COUNT)
+                bits |= static_cast<std::uint64_t>(static_cast<unsigned char>(m_buffer[sizeof(word)])) << (WORD_BIT_COUNT - m_firstByteOffset);
+            return static_cast<IntegralType>(bits & SymbolMask);
         }
-        
+
     private:
         char* const m_buffer;
-        int m_byteCount;
         int m_firstByteOffset;
     };
-    
+
+    template<std::size_t SymbolSize>
+    constexpr std::uint64_t Symbol<SymbolSize>::SymbolMask;
+
+    //Symbolset is a packed array of SymbolSize bits symbols. when SymbolSize divides the word size no symbol crosses
+    //a word, allowing the bulk operations (Fill, Count, FindFirst) to process a whole word of symbols at a time.
     template<std::size_t SymbolSize>
     class Symbolset
     {
     public:
+        static const std::size_t NPos = std::numeric_limits<std::size_t>::max();
+
         Symbolset(std::size_t numOfSymbols)
+            :m_numOfSymbols(numOfSymbols)
         {
-            int totalBitCount = SymbolSize * numOfSymbols;
-            int byteCount = totalBitCount % BYTE_BIT_COUNT == 0 ? totalBitCount / BYTE_BIT_COUNT :
-                            (totalBitCount / BYTE_BIT_COUNT) + 1;
-            m_buffer = new char[byteCount];
-            memset(m_buffer, 0, byteCount);
+            Init();
         }
         Symbolset(std::size_t numOfSymbols, long defaultValue)
+            :m_numOfSymbols(numOfSymbols)
+        {
+            Init();
+            Fill(0, m_numOfSymbols, defaultValue);
+        }
+        Symbolset(const Symbolset&) = delete;
+        Symbolset& operator=(const Symbolset&) = delete;
+
+        ~Symbolset(){ delete [] m_words; }
+
+        Symbol<SymbolSize> operator[](std::size_t index)
         {
-            int totalBitCount = SymbolSize * numOfSymbols;
-            int byteCount = totalBitCount % BYTE_BIT_COUNT == 0 ? totalBitCount / BYTE_BIT_COUNT :
-                            (totalBitCount / BYTE_BIT_COUNT) + 1;
-            m_buffer = new char[byteCount];
-            for(unsigned int symbolIdx = 0; symbolIdx < numOfSymbols; symbolIdx++)
+            std::size_t bitIdx = index * SymbolSize;
+            return Symbol<SymbolSize>(m_buffer + bitIdx / BYTE_BIT_COUNT, static_cast<int>(bitIdx % BYTE_BIT_COUNT));
+        }
+
+        std::size_t Size() const { return m_numOfSymbols; }
+
+        //Fill assigns value into all symbols within [first, last).
+        void Fill(std::size_t first, std::size_t last, long value)
+        {
+            if(WordAligned == false)
             {
-                operator[](symbolIdx) = defaultValue;
+                for(std::size_t idx = first; idx < last; idx++)
+                    operator[](idx) = value;
+                return;
             }
+            std::size_t idx = first;
+            for(; idx < last && idx % SymbolsPerWord != 0; idx++)
+                operator[](idx) = value;
+            std::uint64_t pattern = Pattern(value);
+            for(; idx + SymbolsPerWord <= last; idx += SymbolsPerWord)
+                m_words[idx / SymbolsPerWord] = pattern;
+            for(; idx < last; idx++)
+                operator[](idx) = value;
         }
-        
-        ~Symbolset(){ delete [] m_buffer; }
-        
-        Symbol<SymbolSize> operator[](std::size_t index)
+
+        //Count returns the number of symbols within [first, last) equal to value.
+        std::size_t Count(long value, std::size_t first = 0, std::size_t last = NPos)
+        {
+            last = std::min(last, m_numOfSymbols);
+            std::size_t count = 0;
+            std::size_t idx = first;
+            if(WordAligned)
+            {
+                for(; idx < last && idx % SymbolsPerWord != 0; idx++)
+                    count += Matches(idx, value) ? 1 : 0;
+                std::uint64_t pattern = Pattern(value);
+                for(; idx + SymbolsPerWord <= last; idx += SymbolsPerWord)
+                    count += symbol_detail::PopCount(MatchingSymbols(m_words[idx / SymbolsPerWord], pattern));
+            }
+            for(; idx < last; idx++)
+                count += Matches(idx, value) ? 1 : 0;
+            return count;
+        }
+
+        //FindFirst returns the index of the first symbol at or after from equal to value, or NPos.
+        std::size_t FindFirst(long value, std::size_t from = 0)
+        {
+            std::size_t idx = from;
+            if(WordAligned)
+            {
+                for(; idx < m_numOfSymbols && idx % SymbolsPerWord != 0; idx++)
+                    if(Matches(idx, value))
+                        return idx;
+                std::uint64_t pattern = Pattern(value);
+                for(; idx + SymbolsPerWord <= m_numOfSymbols; idx += SymbolsPerWord)
+                {
+                    std::uint64_t matches = MatchingSymbols(m_words[idx / SymbolsPerWord], pattern);
+                    if(matches)
+                        return idx + symbol_detail::TrailingZeros(matches) / SymbolSize;
+                }
+            }
+            for(; idx < m_numOfSymbols; idx++)
+                if(Matches(idx, value))
+                    return idx;
+            return NPos;
+        }
+
+    private:
+        static const bool WordAligned = WORD_BIT_COUNT % SymbolSize == 0;
+        static const std::size_t SymbolsPerWord = WORD_BIT_COUNT / SymbolSize;
+        static constexpr std::uint64_t LowBits = Symbol<SymbolSize>::SymbolMask == ~static_cast<std::uint64_t>(0) ?
+                                                 1 : ~static_cast<std::uint64_t>(0) / Symbol<SymbolSize>::SymbolMask; //Lsb of every symbol
+        static constexpr std::uint64_t HighBits = LowBits << (SymbolSize - 1); //Msb of every symbol
+
+        void Init()
+        {
+            std::size_t wordCount = (SymbolSize * m_numOfSymbols + WORD_BIT_COUNT - 1) / WORD_BIT_COUNT + 1; //Padding word for Symbol's word access
+            m_words = new std::uint64_t[wordCount];
+            memset(m_words, 0, wordCount * sizeof(std::uint64_t));
+            m_buffer = reinterpret_cast<char*>(m_words);
+        }
+
+        bool Matches(std::size_t idx, long value)
+        {
+            return operator[](idx).template ToIntegralType<std::uint64_t>() == (static_cast<std::uint64_t>(value) & Symbol<SymbolSize>::SymbolMask);
+        }
+
+        static std::uint64_t Pattern(long value)
         {
-            int byteCount = static_cast<int>(index * SymbolSize) / BYTE_BIT_COUNT;
-            int bitOffset =  (int)(index * SymbolSize) % BYTE_BIT_COUNT;
-            return Symbol<SymbolSize>(m_buffer + byteCount, bitOffset);
+            return (static_cast<std::uint64_t>(value) & Symbol<SymbolSize>::SymbolMask) * LowBits;
         }
-    
+
+        //MatchingSymbols returns a word with the msb of every symbol equal to pattern set.
+        static std::uint64_t MatchingSymbols(std::uint64_t word, std::uint64_t pattern)
+        {
+            std::uint64_t diff = word ^ pattern;
+            std::uint64_t lowerBitsSet = (diff & ~HighBits) + ~HighBits; //Msb is set if any of the lower bits is set
+            return ~(lowerBitsSet | diff | ~HighBits);
+        }
+
     private:
+        std::size_t m_numOfSymbols;
+        std::uint64_t* m_words;
         char* m_buffer;
     };
+
+    template<std::size_t SymbolSize>
+    const std::size_t Symbolset<SymbolSize>::NPos;
+    template<std::size_t SymbolSize>
+    constexpr std::uint64_t Symbolset<SymbolSize>::LowBits;
+    template<std::size_t SymbolSize>
+    constexpr std::uint64_t Symbolset<SymbolSize>::HighBits;
 }
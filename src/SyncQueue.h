@@ -1,22 +1,38 @@
 #pragma once
 
 #include <queue>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <string>
 #include <vector>
+#include <type_traits>
+#include "LockProfiler.h"
 
 namespace core
 {
-    template <typename T>
+    //SyncQueue is guarded by Lockable, any lock constructible from a LockSite (ProfiledMutex, MCSLock, TicketLock),
+    //locks other than the default are waited upon through std::condition_variable_any.
+    template <typename T, typename Lockable = ProfiledMutex>
     class SyncQueue
     {
+    private:
+        typedef typename std::conditional<std::is_same<Lockable, ProfiledMutex>::value,
+                ProfiledMutexLock, std::unique_lock<Lockable>>::type _lock;
+        typedef typename std::conditional<std::is_same<Lockable, ProfiledMutex>::value,
+                ProfiledConditionVariable, std::condition_variable_any>::type _condition_var;
+
     public:
         typedef T value_type;
         
-        SyncQueue() = default;
+        explicit SyncQueue(const LockSite& site = LockSite::Current()): m_mutex(site){}
         ~SyncQueue() = default;
         SyncQueue(const SyncQueue& object):m_queue(object.m_queue){}
+        SyncQueue(SyncQueue&& object)
+        {
+            _lock localLock(object.m_mutex);
+            m_queue = std::move(object.m_queue);
+        }
         SyncQueue& operator=(const SyncQueue& rhs)
         {
             m_queue = rhs.m_queue;
@@ -26,51 +42,109 @@ namespace core
         //upon their insertion.
         void push(const std::vector<T>& elements)
         {
-            std::unique_lock<std::mutex>(m_mutex);
+            _lock localLock(m_mutex);
             for(const T& element : elements)
             {
                 m_queue.push(element);
                 m_conditionVar.notify_one();
             }
         }
+        
+        void push(std::vector<T>&& elements)
+        {
+            _lock localLock(m_mutex);
+            for(T& element : elements)
+            {
+                m_queue.push(std::move(element));
+                m_conditionVar.notify_one();
+            }
+        }
 
         void push(const T& element)
         {
-            std::unique_lock<std::mutex> localLock(m_mutex);
+            _lock localLock(m_mutex);
             m_queue.push(element);
             m_conditionVar.notify_one();
         }
+        
+        void push(T&& element)
+        {
+            _lock localLock(m_mutex);
+            m_queue.push(std::move(element));
+            m_conditionVar.notify_one();
+        }
+        
+        //emplace constructs the element in place, within the queue.
+        template<typename... Args>
+        void emplace(Args&&... args)
+        {
+            _lock localLock(m_mutex);
+            m_queue.emplace(std::forward<Args>(args)...);
+            m_conditionVar.notify_one();
+        }
         //TryAndPop verifies if the stored queue is empty or not - if empty it will not assign a stored value into the received element.
         // and will return false (no element was retrieved), if not empty it will fetch the top element, assigning it into the received
-        // element and returning true as a response (an element was fetched).
+        // element (moved out) and returning true as a response (an element was fetched).
         bool try_pop(T& element)
         {
-            std::unique_lock<std::mutex> localLock(m_mutex);
+            _lock localLock(m_mutex);
             if(m_queue.empty())
                 return false;
             
-            element = m_queue.front();
+            element = std::move(m_queue.front());
             m_queue.pop();
             return true;
         }
 
         void pop(T& element)
         {
-            std::unique_lock<std::mutex> localLock(m_mutex);
+            _lock localLock(m_mutex);
             m_conditionVar.wait(localLock, [this]()->bool{return !m_queue.empty();});
-            element = m_queue.front();
+            element = std::move(m_queue.front());
+            m_queue.pop();
+        }
+        
+        //pop_until returns false if no element was received up until atime.
+        template<typename Clock, typename Duration>
+        bool pop_until(T& element, const std::chrono::time_point<Clock, Duration>& atime)
+        {
+            _lock localLock(m_mutex);
+            if(m_conditionVar.wait_until(localLock, atime, [this]()->bool{return !m_queue.empty();}) == false)
+                return false;
+            element = std::move(m_queue.front());
             m_queue.pop();
+            return true;
+        }
+        
+        template<typename Rep, typename Period>
+        bool pop_for(T& element, const std::chrono::duration<Rep, Period>& rtime)
+        {
+            return pop_until(element, std::chrono::steady_clock::now() + rtime);
+        }
+        
+        //drain moves up to maxCount elements into out (appending) under a single lock acquisition, without blocking,
+        //returns the number of elements moved.
+        std::size_t drain(std::vector<T>& out, std::size_t maxCount)
+        {
+            _lock localLock(m_mutex);
+            std::size_t count = 0;
+            for(; count < maxCount && m_queue.empty() == false; count++)
+            {
+                out.push_back(std::move(m_queue.front()));
+                m_queue.pop();
+            }
+            return count;
         }
 
         bool is_empty() const
         {
-            std::unique_lock<std::mutex> localLock(m_mutex);
+            _lock localLock(m_mutex);
             return m_queue.empty();
         }
 
     private:
         std::queue<T> m_queue;
-        mutable std::condition_variable m_conditionVar;
-        mutable std::mutex m_mutex;
+        mutable _condition_var m_conditionVar;
+        mutable Lockable m_mutex;
     };
 }
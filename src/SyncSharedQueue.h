@@ -3,6 +3,7 @@
 #include <string>
 #include <atomic>
 #include <mutex>
+#include <chrono>
 #include "SharedObject.h"
 #include "Mutex.h"
 #include "Condition.h"
@@ -29,7 +30,7 @@ namespace core{
             return false;
         }
     
-        bool write(value_type& elem)
+        bool write(const value_type& elem)
         {
             if(!is_full())
             {
@@ -40,6 +41,19 @@ namespace core{
             return false;
         }
         
+        //emplace constructs the element and moves it into its slot (slots are constructed along with the buffer).
+        template<typename... Args>
+        bool emplace(Args&&... args)
+        {
+            if(!is_full())
+            {
+                m_buffer[m_writeIdx] = value_type(std::forward<Args>(args)...);
+                m_writeIdx = (m_writeIdx + 1) % Count;
+                return true;
+            }
+            return false;
+        }
+        
         template<typename X = value_type>
         typename std::enable_if<std::is_move_assignable<X>::value, bool>::type read(value_type& elem)
         {
@@ -88,9 +102,9 @@ namespace core{
             if(m_owner)
             {
                 m_buffer = new(m_region.GetPtr() + offset)SWSRCyclicBuffer<Type, Count>();
-                m_mutex = new(reinterpret_cast<char*>(m_buffer) + sizeof(SWSRCyclicBuffer<Type, Count>))Mutex();
-                m_cvFull = new(reinterpret_cast<char*>(m_mutex) + sizeof(Mutex))ConditionVariable();
-                m_cvEmpty = new(reinterpret_cast<char*>(m_cvFull) + sizeof(ConditionVariable))ConditionVariable();
+                m_mutex = new(reinterpret_cast<char*>(m_buffer) + sizeof(SWSRCyclicBuffer<Type, Count>))Mutex(Mutex::Mode::ADAPTIVE, Futex::Scope::SHARED);
+                m_cvFull = new(reinterpret_cast<char*>(m_mutex) + sizeof(Mutex))ConditionVariable(Futex::Scope::SHARED);
+                m_cvEmpty = new(reinterpret_cast<char*>(m_cvFull) + sizeof(ConditionVariable))ConditionVariable(Futex::Scope::SHARED);
             }
             else
             {
@@ -107,9 +121,9 @@ namespace core{
             if(m_owner)
             {
                 m_buffer = new(buffer)SWSRCyclicBuffer<Type, Count>();
-                m_mutex = new(reinterpret_cast<char*>(m_buffer) + sizeof(SWSRCyclicBuffer<Type, Count>))Mutex();
-                m_cvFull = new(reinterpret_cast<char*>(m_mutex) + sizeof(Mutex))ConditionVariable();
-                m_cvEmpty = new(reinterpret_cast<char*>(m_cvFull) + sizeof(ConditionVariable))ConditionVariable();
+                m_mutex = new(reinterpret_cast<char*>(m_buffer) + sizeof(SWSRCyclicBuffer<Type, Count>))Mutex(Mutex::Mode::ADAPTIVE, Futex::Scope::SHARED);
+                m_cvFull = new(reinterpret_cast<char*>(m_mutex) + sizeof(Mutex))ConditionVariable(Futex::Scope::SHARED);
+                m_cvEmpty = new(reinterpret_cast<char*>(m_cvFull) + sizeof(ConditionVariable))ConditionVariable(Futex::Scope::SHARED);
             }
             else
             {
@@ -149,6 +163,16 @@ namespace core{
             return true;
         }
     
+        template<typename... Args>
+        bool try_emplace(Args&&... args)
+        {
+            std::lock_guard<Mutex> lock(*m_mutex);
+            if(m_buffer->emplace(std::forward<Args>(args)...) == false)
+                return false;
+            m_cvEmpty->notify_one();
+            return true;
+        }
+    
         template<typename ElementType>
         bool try_pop(ElementType& element)
         {
@@ -167,6 +191,14 @@ namespace core{
             m_cvEmpty->notify_one();
         }
         
+        template<typename... Args>
+        void emplace(Args&&... args)
+        {
+            std::unique_lock<Mutex> lock(*m_mutex);
+            m_cvFull->wait(lock, [&args..., this]{return m_buffer->emplace(std::forward<Args>(args)...);});
+            m_cvEmpty->notify_one();
+        }
+        
         template<typename ElementType>
         void pop(ElementType& element)
         {
@@ -175,6 +207,23 @@ namespace core{
             m_cvFull->notify_one();
         }
         
+        //pop_until returns false if no element was received up until atime.
+        template<typename ElementType, typename Clock, typename Duration>
+        bool pop_until(ElementType& element, const std::chrono::time_point<Clock, Duration>& atime)
+        {
+            std::unique_lock<Mutex> lock(*m_mutex);
+            if(m_cvEmpty->wait_until(lock, atime, [&element, this]{return m_buffer->read(element);}) == false)
+                return false;
+            m_cvFull->notify_one();
+            return true;
+        }
+        
+        template<typename ElementType, typename Rep, typename Period>
+        bool pop_for(ElementType& element, const std::chrono::duration<Rep, Period>& rtime)
+        {
+            return pop_until(element, std::chrono::steady_clock::now() + rtime);
+        }
+        
     private:
         std::unique_ptr<SharedObject> m_sharedObject;
         SharedRegion m_region;
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <limits>
+#include <cstdint>
+#include "Futex.h"
+#include "Cpu.h"
+#include "LockProfiler.h"
+
+namespace core{
+
+    //TicketLock is a fair lock, waiters are granted the lock in the order they drew their tickets. all of its state
+    //resides within the object, making it usable in shared memory (where MCSLock, which links thread local nodes,
+    //isn't). waiters spin on the serving counter and, after a while, park on a futex over it, a release wakes the
+    //parked waiters (all of them, as the next ticket's holder can't be targeted) only when there are any.
+    class TicketLock
+    {
+    public:
+        explicit TicketLock(Futex::Scope scope = Futex::Scope::SHARED, const LockSite& site = LockSite::Current())
+            : m_next(0), m_serving(0), m_parked(0), m_scope(scope)
+        #if defined(CORE_LOCK_PROFILING)
+            , m_probe(site.source)
+        #endif
+        {}
+        explicit TicketLock(const LockSite& site): TicketLock(Futex::Scope::SHARED, site){}
+        TicketLock(const TicketLock&) = delete;
+        TicketLock& operator=(const TicketLock&) = delete;
+
+        void lock()
+        {
+            std::uint32_t ticket = m_next.fetch_add(1, std::memory_order_relaxed);
+            std::uint32_t serving = m_serving.load(std::memory_order_acquire);
+            if(serving == ticket)
+            {
+                OnAcquire(0);
+                return;
+            }
+
+            std::int64_t waitStart = WaitStart();
+            const int spinCount = 1000;
+            for(int spin = 0; serving != ticket; spin++, serving = m_serving.load(std::memory_order_acquire))
+            {
+                if(spin < spinCount)
+                {
+                    CpuRelax();
+                    continue;
+                }
+                m_parked.fetch_add(1, std::memory_order_seq_cst);
+                if(m_serving.load(std::memory_order_seq_cst) == serving)
+                    Futex::Wait(&m_serving, static_cast<int>(serving), m_scope);
+                m_parked.fetch_sub(1, std::memory_order_relaxed);
+            }
+            OnAcquire(waitStart);
+        }
+
+        bool try_lock()
+        {
+            std::uint32_t serving = m_serving.load(std::memory_order_acquire);
+            std::uint32_t ticket = serving;
+            if(m_next.compare_exchange_strong(ticket, serving + 1, std::memory_order_acquire) == false)
+                return false;
+            OnAcquire(0);
+            return true;
+        }
+
+        void unlock()
+        {
+        #if defined(CORE_LOCK_PROFILING)
+            m_probe.OnRelease();
+        #endif
+            m_serving.fetch_add(1, std::memory_order_seq_cst);
+            if(m_parked.load(std::memory_order_seq_cst) != 0)
+                Futex::Wake(&m_serving, std::numeric_limits<int>::max(), m_scope);
+        }
+
+    private:
+        std::int64_t WaitStart()
+        {
+        #if defined(CORE_LOCK_PROFILING)
+            return LockProfiler::Now();
+        #else
+            return 0;
+        #endif
+        }
+
+        void OnAcquire(std::int64_t waitStart)
+        {
+        #if defined(CORE_LOCK_PROFILING)
+            m_probe.OnAcquire(waitStart);
+        #endif
+        }
+
+    private:
+        alignas(64) std::atomic<std::uint32_t> m_next;
+        alignas(64) std::atomic<std::uint32_t> m_serving;
+        std::atomic<int> m_parked;
+        const Futex::Scope m_scope;
+    #if defined(CORE_LOCK_PROFILING)
+        LockProbe m_probe;
+    #endif
+    };
+}
@@ -0,0 +1,187 @@
+#include "UnixSocket.h"
+#include <cstring>
+#if defined(__linux)
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "Assert.h"
+
+using namespace std;
+
+namespace core
+{
+    namespace
+    {
+        #if defined(__linux)
+        sockaddr_un GetSocketAddress(const string& path)
+        {
+            sockaddr_un address;
+            memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            VERIFY(path.size() < sizeof(address.sun_path), "Socket path is too long - %s", path.c_str());
+            strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+            return address;
+        }
+        #endif
+    }
+
+    UnixSocket::UnixSocket(int fd): m_fd(fd){}
+
+    UnixSocket::~UnixSocket()
+    {
+        Close();
+    }
+
+    UnixSocket::UnixSocket(UnixSocket&& obj): m_fd(Invalid_Socket)
+    {
+        swap(m_fd, obj.m_fd);
+    }
+
+    UnixSocket& UnixSocket::operator=(UnixSocket&& obj)
+    {
+        Close();
+        swap(m_fd, obj.m_fd);
+        return *this;
+    }
+
+    UnixSocket UnixSocket::Listen(const string& path, int backlog)
+    {
+        #if defined(__linux)
+        UnixSocket socket(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        PLATFORM_VERIFY(socket.m_fd != Invalid_Socket);
+        sockaddr_un address = GetSocketAddress(path);
+        struct stat fileStat;
+        if(::lstat(path.c_str(), &fileStat) == 0) //Only a stale socket is removed, never a file which happens to be there
+        {
+            VERIFY(S_ISSOCK(fileStat.st_mode), "Socket path is taken by a file which is not a socket - %s", path.c_str());
+            //A socket nobody listens on refuses connections, a live listener's is left to it
+            UnixSocket probe(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+            PLATFORM_VERIFY(probe.m_fd != Invalid_Socket);
+            int result;
+            while((result = ::connect(probe.m_fd, (const struct sockaddr*)&address, sizeof(address))) == -1 && errno == EINTR);
+            VERIFY(result == -1, "Socket path is in use by a live listener - %s", path.c_str());
+            PLATFORM_VERIFY(errno == ECONNREFUSED || errno == ENOENT);
+            PLATFORM_VERIFY(::unlink(path.c_str()) == 0 || errno == ENOENT);
+        }
+        else
+            PLATFORM_VERIFY(errno == ENOENT);
+        PLATFORM_VERIFY(::bind(socket.m_fd, (const struct sockaddr*)&address, sizeof(address)) == 0);
+        PLATFORM_VERIFY(::listen(socket.m_fd, backlog) == 0);
+        return socket;
+        #else
+        throw Exception(__CORE_SOURCE, "UnixSocket is only supported in linux platform");
+        #endif
+    }
+
+    UnixSocket UnixSocket::Connect(const string& path)
+    {
+        #if defined(__linux)
+        UnixSocket socket(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        PLATFORM_VERIFY(socket.m_fd != Invalid_Socket);
+        sockaddr_un address = GetSocketAddress(path);
+        PLATFORM_VERIFY(::connect(socket.m_fd, (const struct sockaddr*)&address, sizeof(address)) == 0);
+        return socket;
+        #else
+        throw Exception(__CORE_SOURCE, "UnixSocket is only supported in linux platform");
+        #endif
+    }
+
+    pair<UnixSocket, UnixSocket> UnixSocket::Pair()
+    {
+        #if defined(__linux)
+        int fds[2];
+        PLATFORM_VERIFY(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+        return make_pair(UnixSocket(fds[0]), UnixSocket(fds[1]));
+        #else
+        throw Exception(__CORE_SOURCE, "UnixSocket is only supported in linux platform");
+        #endif
+    }
+
+    UnixSocket UnixSocket::Accept()
+    {
+        #if defined(__linux)
+        int fd = ::accept4(m_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        PLATFORM_VERIFY(fd != Invalid_Socket);
+        return UnixSocket(fd);
+        #else
+        throw Exception(__CORE_SOURCE, "UnixSocket is only supported in linux platform");
+        #endif
+    }
+
+    void UnixSocket::SendDescriptor(int descriptor)
+    {
+        #if defined(__linux)
+        char payload = 0; //At least a single byte of data must accompany the ancillary data
+        iovec io = {&payload, sizeof(payload)};
+        char control[CMSG_SPACE(sizeof(int))];
+        memset(control, 0, sizeof(control));
+
+        msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &io;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        cmsghdr* header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(header), &descriptor, sizeof(int));
+
+        ssize_t sent;
+        while((sent = ::sendmsg(m_fd, &message, MSG_NOSIGNAL)) == -1 && errno == EINTR);
+        PLATFORM_VERIFY(sent == sizeof(payload));
+        #endif
+    }
+
+    int UnixSocket::ReceiveDescriptor()
+    {
+        #if defined(__linux)
+        char payload;
+        iovec io = {&payload, sizeof(payload)};
+        char control[CMSG_SPACE(sizeof(int))];
+        memset(control, 0, sizeof(control));
+
+        msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &io;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        ssize_t received;
+        while((received = ::recvmsg(m_fd, &message, MSG_CMSG_CLOEXEC)) == -1 && errno == EINTR);
+        PLATFORM_VERIFY(received != -1);
+        VERIFY(received == sizeof(payload), "Connection was closed before a descriptor was received");
+        cmsghdr* header = CMSG_FIRSTHDR(&message);
+        bool attached = header != nullptr && header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS;
+        size_t count = attached ? (header->cmsg_len - CMSG_LEN(0)) / sizeof(int) : 0;
+        int descriptors[(sizeof(control) - CMSG_LEN(0)) / sizeof(int)]; //As many as the control buffer may hold
+        if(count != 0)
+            memcpy(descriptors, CMSG_DATA(header), count * sizeof(int));
+        if((message.msg_flags & MSG_CTRUNC) || count > 1) //More descriptors were sent than expected, the ones which didn't fit are lost
+        {
+            for(size_t idx = 0; idx < count; idx++)
+                ::close(descriptors[idx]);
+            throw Exception(__CORE_SOURCE, "Received ancillary data was truncated");
+        }
+        VERIFY(count == 1, "No descriptor was attached to the received message");
+        return descriptors[0];
+        #else
+        throw Exception(__CORE_SOURCE, "UnixSocket is only supported in linux platform");
+        #endif
+    }
+
+    void UnixSocket::Close()
+    {
+        #if defined(__linux)
+        if(m_fd != Invalid_Socket)
+            ::close(m_fd);
+        #endif
+        m_fd = Invalid_Socket;
+    }
+}
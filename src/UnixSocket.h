@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <utility>
+
+namespace core
+{
+    //Provides a unix domain stream socket, intended for passing descriptors (SCM_RIGHTS) between processes
+    //running on the same host, including:
+    //1) Listening on a path and accepting connections while in server variation.
+    //2) Connecting to a path while in client variation.
+    //3) Sending/Receiving descriptors.
+    class UnixSocket
+    {
+    public:
+        explicit UnixSocket(int fd);
+        ~UnixSocket();
+        UnixSocket(UnixSocket&& obj);
+        UnixSocket& operator=(UnixSocket&& obj);
+        UnixSocket(const UnixSocket&) = delete;
+        UnixSocket& operator=(const UnixSocket&) = delete;
+
+        //Listen will bind a new socket to path (removing a stale socket file, a file of another type or a socket with a
+        //live listener is left intact and fails the call) and designate it to accept connections.
+        static UnixSocket Listen(const std::string& path, int backlog = 16);
+        static UnixSocket Connect(const std::string& path);
+        //Pair creates two connected sockets, useful for a parent and a forked child.
+        static std::pair<UnixSocket, UnixSocket> Pair();
+        UnixSocket Accept();
+        //SendDescriptor passes descriptor to the peer, the peer receives a new descriptor to the same open file.
+        void SendDescriptor(int descriptor);
+        //ReceiveDescriptor blocks until a descriptor is received, the caller owns the returned descriptor.
+        int ReceiveDescriptor();
+        void Close();
+        int GetDescriptor() const { return m_fd; }
+
+    private:
+        static const int Invalid_Socket = -1;
+        int m_fd;
+    };
+}
@@ -1,17 +1,41 @@
 #include "gtest/gtest.h"
 #include <sstream>
+#include <algorithm>
 #include <mutex>
+#include <shared_mutex>
 #include <thread>
 #include <chrono>
+#include <vector>
+#include <unordered_map>
+#include <sys/socket.h>
 #include "src/Param.h"
 #include "src/Process.h"
 #include "src/SharedObject.h"
+#include "src/UnixSocket.h"
 #include "src/SymbolSet.h"
+#include "src/AtomicSymbolSet.h"
 #include "src/Allocator.h"
+#include "src/MonotonicArena.h"
+#include "src/SharedContainers.h"
 #include "src/Mutex.h"
 #include "src/Thread.h"
 #include "src/Condition.h"
+#include "src/RWMutex.h"
+#include "src/LockProfiler.h"
+#include "src/MCSLock.h"
+#include "src/TicketLock.h"
+#include "src/SyncQueue.h"
+#include "src/ConcurrentDictionary.h"
+#include "src/ConcurrentHashMap.h"
+#include "src/ConcurrentCache.h"
+#include "src/DefaultLogger.h"
+#include "src/Pipe.h"
 #include "src/SyncSharedQueue.h"
+#include "src/BroadcastRing.h"
+#include "src/SeqLock.h"
+#include "src/Latch.h"
+#include "src/Barrier.h"
+#include "src/Semaphore.h"
 #include "src/AsyncTask.h"
 #include "src/AsyncExecutor.h"
 
@@ -92,6 +116,62 @@ namespace coreTest
         object.Unlink();
     }
     
+    TEST(Core, AnonymousSharedObject)
+    {
+        std::pair<core::UnixSocket, core::UnixSocket> sockets = core::UnixSocket::Pair();
+        std::function<void(void)> func = [&sockets]{
+            sockets.first.Close();
+            core::AnonymousSharedObject object("Core_Test_Anonymous");
+            object.Allocate(10000);
+            core::SharedRegion region = object.Map(8188, 5, core::SharedObject::AccessMod::READ_WRITE);//Will cross page boundries
+            memcpy(region.GetPtr(), "Hello", region.GetSize());
+            region.UnMap();
+            object.AddSeals(core::AnonymousSharedObject::SEAL_SHRINK | core::AnonymousSharedObject::SEAL_GROW);
+            sockets.second.SendDescriptor(object.GetHandle());
+        };
+        core::ChildProcess child = core::Process::SpawnChildProcess(func);
+        sockets.second.Close();
+        core::AnonymousSharedObject object(sockets.first.ReceiveDescriptor());
+        ASSERT_EQ(object.GetSize(), 10000);
+        ASSERT_EQ(object.GetSeals(), core::AnonymousSharedObject::SEAL_SHRINK | core::AnonymousSharedObject::SEAL_GROW);
+        core::SharedRegion region = object.Map(8188, 5, core::SharedObject::AccessMod::READ);
+        ASSERT_EQ(std::string(region.GetPtr(), region.GetSize()), "Hello");
+        region.UnMap();
+        child.wait();
+    }
+    
+    TEST(Core, MappedFile)
+    {
+        const std::string path = "/tmp/Core_MappedFile_Test";
+        {
+            core::MappedFile file(path, core::SharedObject::AccessMod::READ_WRITE, true);
+            file.Allocate(10000);
+            ASSERT_EQ(file.GetSize(), 10000);
+            core::SharedRegion region = file.Map(8188, 5, core::SharedObject::AccessMod::READ_WRITE);//Will cross page boundries
+            memcpy(region.GetPtr(), "Hello", region.GetSize());
+            region.Sync(false);
+            region.UnMap();
+        }
+        core::MappedFile file(path, core::SharedObject::AccessMod::READ);
+        core::SharedRegion region = file.Map(0, file.GetSize(), core::SharedObject::AccessMod::READ);
+        region.Advise(core::SharedRegion::Advice::SEQUENTIAL);
+        region.Advise(core::SharedRegion::Advice::WILL_NEED, 8188, 5);
+        ASSERT_EQ(std::string(region.GetPtr() + 8188, 5), "Hello");
+        region.UnMap();
+        {
+            core::MappedFile file(path, core::SharedObject::AccessMod::READ_WRITE);
+            const size_t offset = 3UL * 1024 * 1024 * 1024 + 12; //Beyond 2GB, the file is sparse
+            file.Allocate(offset + 5);
+            core::SharedRegion region = file.Map(offset, 5, core::SharedObject::AccessMod::READ_WRITE);
+            memcpy(region.GetPtr(), "World", region.GetSize());
+            region.UnMap();
+            core::SharedRegion readRegion = file.Map(offset, 5, core::SharedObject::AccessMod::READ);
+            ASSERT_EQ(std::string(readRegion.GetPtr(), 5), "World");
+            readRegion.UnMap();
+        }
+        ::unlink(path.c_str());
+    }
+    
     TEST(Core, SymbolSet)
     {
         core::Symbolset<3> symbolset(4, 5);
@@ -99,6 +179,61 @@ namespace coreTest
         core::Symbolset<2> symbolset_2(15, 0);
         symbolset_2[14] = 2;
         ASSERT_EQ((int)symbolset_2[14], 2);
+        core::Symbolset<60> symbolset_60(5, 0); //Symbols cross word boundaries
+        symbolset_60[3] = 0xABCDEF012345678L;
+        ASSERT_EQ((long)symbolset_60[3], 0xABCDEF012345678L);
+        ASSERT_EQ((long)symbolset_60[2], 0);
+        ASSERT_EQ((long)symbolset_60[4], 0);
+    }
+    
+    TEST(Core, SymbolSetBulk)
+    {
+        core::Symbolset<2> symbolset(200, 1);
+        ASSERT_EQ(symbolset.Count(1), 200);
+        symbolset.Fill(10, 150, 2);
+        ASSERT_EQ(symbolset.Count(2), 140);
+        ASSERT_EQ(symbolset.Count(1, 0, 100), 10);
+        ASSERT_EQ(symbolset.FindFirst(2), 10);
+        ASSERT_EQ(symbolset.FindFirst(1, 10), 150);
+        ASSERT_EQ(symbolset.FindFirst(0), core::Symbolset<2>::NPos);
+        symbolset[197] = 0;
+        ASSERT_EQ(symbolset.FindFirst(0), 197);
+        
+        core::Symbolset<3> symbolset_3(100, 5);
+        symbolset_3.Fill(40, 60, 2);
+        ASSERT_EQ(symbolset_3.Count(5), 80);
+        ASSERT_EQ(symbolset_3.FindFirst(2), 40);
+    }
+    
+    TEST(Core, AtomicSymbolSet)
+    {
+        const int threadsCount = 8;
+        alignas(8) char buffer[core::AtomicSymbolset<4>::chunk_size(threadsCount)];
+        core::AtomicSymbolset<4> symbolset(buffer, threadsCount, true); //All symbols share a single word
+        std::vector<std::unique_ptr<core::Thread>> threads;
+        for(int idx = 0; idx < threadsCount; idx++)
+        {
+            threads.emplace_back(new core::Thread("Updater", [&symbolset, idx]{
+                for(int iteration = 0; iteration < 10000; iteration++)
+                {
+                    symbolset.FetchAdd(idx, 1);
+                    symbolset.FetchSub(idx, 1);
+                }
+                symbolset.Store(idx, idx);
+            }));
+        }
+        for(auto& thread : threads)
+            thread->join();
+        
+        for(int idx = 0; idx < threadsCount; idx++)
+            ASSERT_EQ(symbolset.Load(idx), idx);
+        std::uint64_t expected = 3;
+        ASSERT_TRUE(symbolset.CompareExchange(3, expected, 15));
+        ASSERT_FALSE(symbolset.CompareExchange(3, expected, 1));
+        ASSERT_EQ(expected, 15);
+        ASSERT_EQ(symbolset.FetchOr(2, 0x1), 2);
+        ASSERT_EQ(symbolset.Load(2), 3);
+        ASSERT_EQ(symbolset.Load(4), 4);
     }
     
     TEST(Core, Allocator)
@@ -114,6 +249,98 @@ namespace coreTest
         allocator.deallocate(ptr);
     }
     
+    TEST(Core, AllocatorStatistics)
+    {
+        core::Allocator<char> allocator(core::HeapType::Shared, "Core_AllocatorStatistics_Test", 8);
+        allocator.EnableCallSiteSampling(1);
+        char* ptr = allocator.allocate(3);
+        char* ptr_2 = allocator.allocate(16);
+        core::AllocatorStatistics statistics = allocator.GetStatistics();
+        ASSERT_EQ(statistics.allocations, 2);
+        ASSERT_EQ(statistics.bytesInUse, 20);
+        ASSERT_EQ(statistics.bytesInUsePerOrder[2], 4);
+        ASSERT_EQ(statistics.bytesInUsePerOrder[4], 16);
+        ASSERT_EQ(statistics.callSites.size(), 2); //Each allocate call is a distinct call site
+        ASSERT_EQ(statistics.callSites[0].second, 1);
+        ASSERT_EQ(statistics.callSites[1].second, 1);
+        allocator.deallocate(ptr);
+        allocator.deallocate(ptr_2);
+        statistics = allocator.GetStatistics();
+        ASSERT_EQ(statistics.deallocations, 2);
+        ASSERT_EQ(statistics.bytesInUse, 0);
+        ASSERT_EQ(statistics.highWaterMark, 20);
+        ASSERT_EQ(statistics.largestAllocatableBlock, 1024 * 1024); //The counters don't take from the chunk
+        char* whole = allocator.allocate(1024 * 1024);
+        whole[1024 * 1024 - 1] = 1; //The whole tree is mapped
+        allocator.deallocate(whole);
+    }
+    
+    TEST(Core, SharedContainers)
+    {
+        typedef core::SharedHashMap<core::SharedString, core::SharedVector<int>> map_type;
+        const int chunkSize = 64 * 1024;
+        core::SharedObject object("Core_SharedContainers_Test", core::SharedObject::AccessMod::READ_WRITE);
+        object.Allocate(chunkSize);
+        core::SharedRegion writerRegion = object.Map(0, chunkSize, core::SharedObject::AccessMod::READ_WRITE);
+        core::SharedRegion readerRegion = object.Map(0, chunkSize, core::SharedObject::AccessMod::READ);
+        ASSERT_NE(writerRegion.GetPtr(), readerRegion.GetPtr());
+        
+        core::Allocator<char> allocator(core::HeapType::Shared, writerRegion.GetPtr(), chunkSize);
+        map_type* writerMap = new(allocator.allocate(sizeof(map_type)))map_type();
+        for(int idx = 0; idx < 50; idx++)
+        {
+            core::SharedString key(std::string("key_") + std::to_string(idx), allocator);
+            core::SharedVector<int> value;
+            ASSERT_TRUE(writerMap->insert(key, std::move(value), allocator));
+            for(int valueIdx = 0; valueIdx <= idx; valueIdx++)
+                writerMap->find(key)->push_back(valueIdx, allocator);
+        }
+        ASSERT_TRUE(writerMap->erase("key_7"));
+        
+        std::ptrdiff_t mapOffset = reinterpret_cast<char*>(writerMap) - writerRegion.GetPtr();
+        const map_type* readerMap = reinterpret_cast<const map_type*>(readerRegion.GetPtr() + mapOffset);
+        ASSERT_EQ(readerMap->size(), 49);
+        ASSERT_EQ(readerMap->find("key_7"), nullptr);
+        const core::SharedVector<int>* vec = readerMap->find(std::string("key_42"));
+        ASSERT_NE(vec, nullptr);
+        ASSERT_EQ(vec->size(), 43);
+        ASSERT_EQ((*vec)[42], 42);
+        int keysCount = 0;
+        readerMap->for_each([&keysCount](const core::SharedString& key, const core::SharedVector<int>&){
+            ASSERT_EQ(std::string(key.c_str(), 4), "key_");
+            keysCount++;
+        });
+        ASSERT_EQ(keysCount, 49);
+        
+        readerRegion.UnMap();
+        writerRegion.UnMap();
+        object.Unlink();
+    }
+    
+    TEST(Core, MonotonicArena)
+    {
+        core::MonotonicArena arena(256);
+        {
+            std::vector<int, core::ArenaAllocator<int>> vec{core::ArenaAllocator<int>(arena)};
+            for(int idx = 0; idx < 1000; idx++)
+                vec.push_back(idx);
+            ASSERT_EQ(vec[999], 999);
+            
+            typedef core::ArenaAllocator<std::pair<const int, int>> map_allocator;
+            std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, map_allocator> map(16, std::hash<int>(),
+                std::equal_to<int>(), map_allocator(arena));
+            for(int idx = 0; idx < 100; idx++)
+                map[idx] = idx * 2;
+            ASSERT_EQ(map[50], 100);
+            ASSERT_TRUE(vec.get_allocator() == core::ArenaAllocator<char>(arena));
+        }
+        ASSERT_GT(arena.GetUsedSize(), 1000 * sizeof(int));
+        arena.Reset();
+        ASSERT_EQ(arena.GetUsedSize(), 0);
+        void* ptr = arena.Allocate(3, 64);
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % 64, 0);
+    }
+    
     TEST(Core, MutexSimple)
     {
         core::Mutex mutex;
@@ -138,6 +365,73 @@ namespace coreTest
         thr_d.join();
     }
     
+    TEST(Core, MutexTimed)
+    {
+        core::Mutex mutex;
+        mutex.lock();
+        core::Thread thr_a("Thread A", [&mutex]{
+            auto start = std::chrono::steady_clock::now();
+            ASSERT_FALSE(mutex.try_lock_for(50ms));
+            ASSERT_GE(std::chrono::steady_clock::now() - start, 50ms);
+            ASSERT_TRUE(mutex.try_lock_for(10s));
+            mutex.unlock();
+        });
+        std::this_thread::sleep_for(100ms);
+        mutex.unlock();
+        thr_a.join();
+    }
+    
+    TEST(Core, MutexAdaptive)
+    {
+        core::Mutex mutex(core::Mutex::Mode::ADAPTIVE);
+        long counter = 0;
+        std::vector<std::unique_ptr<core::Thread>> threads;
+        for(int idx = 0; idx < 4; idx++)
+            threads.emplace_back(new core::Thread("Adaptive", [&mutex, &counter]{
+                for(int iteration = 0; iteration < 100000; iteration++)
+                {
+                    std::lock_guard<core::Mutex> guard(mutex);
+                    counter++;
+                }
+            }));
+        for(auto& thread : threads)
+            thread->join();
+        ASSERT_EQ(counter, 400000);
+        ASSERT_TRUE(mutex.try_lock());
+        ASSERT_FALSE(mutex.try_lock_for(10ms));
+        mutex.unlock();
+    }
+    
+    TEST(Core, ConditionVariableTimed)
+    {
+        core::Mutex mutex;
+        core::ConditionVariable cv;
+        bool signal = false;
+        {
+            std::unique_lock<core::Mutex> lock(mutex);
+            ASSERT_EQ(cv.wait_for(lock, 20ms), std::cv_status::timeout);
+            ASSERT_FALSE(cv.wait_for(lock, 20ms, [&signal]{ return signal; }));
+        }
+        core::Thread thr_signal("Signal", [&mutex, &cv, &signal]{
+            std::this_thread::sleep_for(50ms);
+            std::lock_guard<core::Mutex> guard(mutex);
+            signal = true;
+            cv.notify_all();
+        });
+        {
+            std::unique_lock<core::Mutex> lock(mutex);
+            ASSERT_TRUE(cv.wait_until(lock, std::chrono::system_clock::now() + 10s, [&signal]{ return signal; }));
+        }
+        thr_signal.join();
+        
+        core::SyncSharedQueue<int, 10> queue("Core_Test_SyncSharedQueue_Timed", true, core::SharedObject::AccessMod::READ_WRITE);
+        int item = 0;
+        ASSERT_FALSE(queue.pop_for(item, 20ms));
+        queue.push(5);
+        ASSERT_TRUE(queue.pop_for(item, 20ms));
+        ASSERT_EQ(item, 5);
+    }
+    
     TEST(Core, ConditionSimple)
     {
         core::Mutex mutex;
@@ -209,6 +503,802 @@ namespace coreTest
         thr_signal.join();
     }
     
+    TEST(Core, ConditionVariableRequeue)
+    {
+        core::Mutex mutex(core::Mutex::Mode::BLOCKING, core::Futex::Scope::PRIVATE);
+        core::ConditionVariable cv(core::Futex::Scope::PRIVATE);
+        cv.notify_all(); //No waiters, a no op
+        int round = 0;
+        int woken = 0;
+        const int waitersCount = 8;
+        std::vector<std::unique_ptr<core::Thread>> waiters;
+        for(int idx = 0; idx < waitersCount; idx++)
+            waiters.emplace_back(new core::Thread("Waiter", [&mutex, &cv, &round, &woken]{
+                for(int expected = 1; expected <= 50; expected++)
+                {
+                    std::unique_lock<core::Mutex> lock(mutex);
+                    cv.wait(lock, [&round, expected]{ return round >= expected; });
+                    woken++;
+                    cv.notify_all();
+                }
+            }));
+        for(int expected = 1; expected <= 50; expected++)
+        {
+            std::unique_lock<core::Mutex> lock(mutex);
+            cv.wait(lock, [&woken, expected]{ return woken == (expected - 1) * waitersCount; });
+            round = expected;
+            cv.notify_all();
+        }
+        for(auto& waiter : waiters)
+            waiter->join();
+        ASSERT_EQ(woken, 50 * waitersCount);
+    }
+    
+    TEST(Core, RWMutex)
+    {
+        core::RWMutex mutex(core::Futex::Scope::PRIVATE);
+        long first = 0, second = 0;
+        std::atomic<bool> violated(false);
+        std::vector<std::unique_ptr<core::Thread>> threads;
+        for(int idx = 0; idx < 4; idx++)
+            threads.emplace_back(new core::Thread("Reader", [&]{
+                for(int iteration = 0; iteration < 20000; iteration++)
+                {
+                    std::shared_lock<core::RWMutex> lock(mutex);
+                    if(first != second)
+                        violated = true;
+                }
+            }));
+        for(int idx = 0; idx < 2; idx++)
+            threads.emplace_back(new core::Thread("Writer", [&]{
+                for(int iteration = 0; iteration < 5000; iteration++)
+                {
+                    if(iteration % 2)
+                    {
+                        std::lock_guard<core::RWMutex> lock(mutex);
+                        first++;
+                        second++;
+                    }
+                    else
+                    {
+                        mutex.lock_shared();
+                        mutex.upgrade();
+                        first++;
+                        second++;
+                        mutex.downgrade();
+                        if(first != second)
+                            violated = true;
+                        mutex.unlock_shared();
+                    }
+                }
+            }));
+        for(auto& thread : threads)
+            thread->join();
+        ASSERT_FALSE(violated);
+        ASSERT_EQ(first, 10000);
+        
+        mutex.lock_shared();
+        ASSERT_FALSE(mutex.try_lock());
+        ASSERT_TRUE(mutex.try_lock_shared());
+        mutex.unlock_shared();
+        ASSERT_TRUE(mutex.upgrade());
+        ASSERT_FALSE(mutex.try_lock_shared());
+        mutex.unlock();
+        ASSERT_TRUE(mutex.try_lock());
+        mutex.unlock();
+    }
+    
+    template<typename Lock>
+    void FairLockTest(Lock& lock)
+    {
+        long counter = 0;
+        std::vector<std::unique_ptr<core::Thread>> threads;
+        for(int idx = 0; idx < 4; idx++)
+            threads.emplace_back(new core::Thread("Fair", [&lock, &counter]{
+                for(int iteration = 0; iteration < 20000; iteration++)
+                {
+                    std::lock_guard<Lock> guard(lock);
+                    counter++;
+                }
+            }));
+        for(auto& thread : threads)
+            thread->join();
+        ASSERT_EQ(counter, 80000);
+        ASSERT_TRUE(lock.try_lock());
+        ASSERT_FALSE(lock.try_lock());
+        lock.unlock();
+    }
+    
+    TEST(Core, FairLocks)
+    {
+        core::MCSLock mcsLock;
+        FairLockTest(mcsLock);
+        core::TicketLock ticketLock(core::Futex::Scope::PRIVATE);
+        FairLockTest(ticketLock);
+        
+        core::MCSLock outer, inner;
+        std::lock_guard<core::MCSLock> outerGuard(outer);
+        std::lock_guard<core::MCSLock> innerGuard(inner);
+        
+        core::SyncQueue<int, core::MCSLock> queue;
+        core::Thread producer("Producer", [&queue]{
+            for(int idx = 0; idx < 1000; idx++)
+                queue.push(idx);
+        });
+        for(int idx = 0; idx < 1000; idx++)
+        {
+            int element = -1;
+            queue.pop(element);
+            ASSERT_EQ(element, idx);
+        }
+        producer.join();
+    }
+    
+    TEST(Core, LockProfiler)
+    {
+        core::ProfiledLock<core::Mutex> mutex;
+        int line = __LINE__ - 1;
+        long counter = 0;
+        std::vector<std::unique_ptr<core::Thread>> threads;
+        for(int idx = 0; idx < 4; idx++)
+            threads.emplace_back(new core::Thread("Profiled", [&mutex, &counter]{
+                for(int iteration = 0; iteration < 1000; iteration++)
+                {
+                    std::lock_guard<core::ProfiledLock<core::Mutex>> guard(mutex);
+                    counter++;
+                }
+            }));
+        for(auto& thread : threads)
+            thread->join();
+        //Forced contention, a thread waits for the lock while it's held
+        mutex.lock();
+        core::Thread blocked("Blocked", [&mutex]{
+            std::lock_guard<core::ProfiledLock<core::Mutex>> guard(mutex);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        mutex.unlock();
+        blocked.join();
+        
+        auto statistics = core::LockProfiler::Collect();
+        auto site = std::find_if(statistics.begin(), statistics.end(), [line](const core::LockSiteStatistics& site){
+            return site.source.line == line && std::string(site.source.file).find("Tests.cpp") != std::string::npos;
+        });
+        ASSERT_NE(site, statistics.end());
+        ASSERT_EQ(site->acquisitions, 4002u);
+        ASSERT_GE(site->contendedAcquisitions, 1u);
+        ASSERT_GE(site->waitNanoseconds, 10 * 1000 * 1000u); //The blocked thread waited for most of the sleep
+        ASSERT_NE(core::LockProfiler::Report().find("Tests.cpp"), std::string::npos);
+    }
+    
+    TEST(Core, SharedSnapshot)
+    {
+        struct Config
+        {
+            long version;
+            long doubled;
+            long tripled;
+        };
+        core::SharedSnapshot<Config> writer("Core_Test_SharedSnapshot", true, core::SharedObject::AccessMod::READ_WRITE);
+        core::SharedSnapshot<Config> reader("Core_Test_SharedSnapshot", false, core::SharedObject::AccessMod::READ_WRITE);
+        writer.publish(Config{0, 0, 0});
+        std::atomic<bool> done(false);
+        std::atomic<bool> torn(false);
+        std::vector<std::unique_ptr<core::Thread>> readers;
+        for(int idx = 0; idx < 3; idx++)
+            readers.emplace_back(new core::Thread("Reader", [&]{
+                long lastVersion = 0;
+                while(done == false)
+                {
+                    Config config = reader.read();
+                    if(config.doubled != config.version * 2 || config.tripled != config.version * 3 || config.version < lastVersion)
+                        torn = true;
+                    lastVersion = config.version;
+                }
+            }));
+        for(long version = 1; version <= 100000; version++)
+        {
+            if(version % 2)
+                writer.publish(Config{version, version * 2, version * 3});
+            else
+                writer.update([version](Config& config){ config.version = version; config.doubled = version * 2; config.tripled = version * 3; });
+        }
+        done = true;
+        for(auto& thread : readers)
+            thread->join();
+        ASSERT_FALSE(torn);
+        Config config;
+        ASSERT_TRUE(reader.try_read(config));
+        ASSERT_EQ(config.version, 100000);
+    }
+    
+    TEST(Core, LatchAndSemaphore)
+    {
+        core::Latch latch(3, core::Futex::Scope::PRIVATE);
+        core::Semaphore semaphore(2, core::Futex::Scope::PRIVATE);
+        std::atomic<int> holders(0);
+        std::atomic<bool> exceeded(false);
+        std::vector<std::unique_ptr<core::Thread>> threads;
+        for(int idx = 0; idx < 3; idx++)
+            threads.emplace_back(new core::Thread("Worker", [&]{
+                latch.arrive_and_wait();
+                for(int iteration = 0; iteration < 1000; iteration++)
+                {
+                    semaphore.acquire();
+                    if(++holders > 2)
+                        exceeded = true;
+                    holders--;
+                    semaphore.release();
+                }
+            }));
+        latch.wait();
+        ASSERT_TRUE(latch.try_wait());
+        for(auto& thread : threads)
+            thread->join();
+        ASSERT_FALSE(exceeded);
+        
+        core::Semaphore empty(0, core::Futex::Scope::PRIVATE);
+        ASSERT_FALSE(empty.try_acquire());
+        ASSERT_FALSE(empty.try_acquire_for(20ms));
+        empty.release();
+        ASSERT_TRUE(empty.try_acquire_for(20ms));
+    }
+    
+    TEST(Core, Barrier)
+    {
+        const int phases = 200;
+        core::SharedObject sharedObject("Core_Test_Barrier", core::SharedObject::AccessMod::READ_WRITE);
+        sharedObject.Allocate(sizeof(core::Barrier) + sizeof(long));
+        core::SharedRegion region = sharedObject.Map(0, sizeof(core::Barrier) + sizeof(long), core::SharedObject::AccessMod::READ_WRITE);
+        core::Barrier* barrier = new(region.GetPtr())core::Barrier(2);
+        long* counter = reinterpret_cast<long*>(region.GetPtr() + sizeof(core::Barrier));
+        *counter = 0;
+        
+        std::function<void(void)> func = [barrier, counter]{
+            for(int phase = 0; phase < phases; phase++)
+            {
+                (*counter)++;
+                barrier->arrive_and_wait();
+                barrier->arrive_and_wait(); //The parent validates meanwhile
+            }
+        };
+        core::ChildProcess process = core::Process::SpawnChildProcess(func);
+        for(int phase = 0; phase < phases; phase++)
+        {
+            ASSERT_EQ(barrier->arrive_and_wait(), static_cast<std::uint32_t>(phase * 2));
+            ASSERT_EQ(*counter, phase + 1);
+            barrier->arrive_and_wait();
+        }
+        ASSERT_EQ(barrier->get_phase(), static_cast<std::uint32_t>(phases * 2));
+        region.UnMap();
+        sharedObject.Unlink();
+    }
+    
+    TEST(Core, SyncQueueDrain)
+    {
+        core::SyncQueue<int> queue;
+        int element = 0;
+        ASSERT_FALSE(queue.pop_for(element, 20ms));
+        queue.push(std::vector<int>{1, 2, 3, 4, 5});
+        std::vector<int> drained;
+        ASSERT_EQ(queue.drain(drained, 3), 3u);
+        ASSERT_EQ(drained, (std::vector<int>{1, 2, 3}));
+        ASSERT_EQ(queue.drain(drained, 10), 2u);
+        ASSERT_EQ(drained.size(), 5u);
+        ASSERT_EQ(queue.drain(drained, 10), 0u);
+        
+        core::Thread producer("Producer", [&queue]{
+            std::this_thread::sleep_for(20ms);
+            queue.push(7);
+        });
+        ASSERT_TRUE(queue.pop_until(element, std::chrono::system_clock::now() + 10s));
+        ASSERT_EQ(element, 7);
+        producer.join();
+    }
+    
+    TEST(Core, SyncQueueMoveOnly)
+    {
+        core::SyncQueue<std::unique_ptr<int>> queue;
+        queue.push(std::unique_ptr<int>(new int(1)));
+        queue.emplace(new int(2));
+        std::vector<std::unique_ptr<int>> batch;
+        batch.emplace_back(new int(3));
+        queue.push(std::move(batch));
+        
+        std::unique_ptr<int> element;
+        queue.pop(element);
+        ASSERT_EQ(*element, 1);
+        ASSERT_TRUE(queue.try_pop(element));
+        ASSERT_EQ(*element, 2);
+        ASSERT_TRUE(queue.pop_for(element, 10ms));
+        ASSERT_EQ(*element, 3);
+        
+        struct Point
+        {
+            Point(): x(0), y(0){}
+            Point(int x, int y): x(x), y(y){}
+            int x;
+            int y;
+        };
+        core::SyncSharedQueue<Point, 4> sharedQueue("Core_Test_SyncSharedQueue_Emplace", true, core::SharedObject::AccessMod::READ_WRITE);
+        const Point point(1, 2);
+        sharedQueue.push(point);
+        sharedQueue.emplace(3, 4);
+        ASSERT_TRUE(sharedQueue.try_emplace(5, 6));
+        Point popped;
+        sharedQueue.pop(popped);
+        ASSERT_EQ(popped.y, 2);
+        sharedQueue.pop(popped);
+        ASSERT_EQ(popped.x, 3);
+        ASSERT_TRUE(sharedQueue.try_pop(popped));
+        ASSERT_EQ(popped.y, 6);
+    }
+    
+    TEST(Core, ConcurrentDictionary)
+    {
+        core::ConcurrentDictionary<int, int> dictionary(5);
+        ASSERT_EQ(dictionary.GetShardsCount(), 8u);
+        std::vector<std::unique_ptr<core::Thread>> threads;
+        for(int idx = 0; idx < 4; idx++)
+            threads.emplace_back(new core::Thread("Writer", [&dictionary, idx]{
+                for(int key = idx * 1000; key < (idx + 1) * 1000; key++)
+                {
+                    dictionary.AddValue(key, key * 2);
+                    if(key % 2)
+                        dictionary.RemoveValue(key);
+                }
+            }));
+        for(auto& thread : threads)
+            thread->join();
+        
+        ASSERT_TRUE(dictionary.ContainsKey(10));
+        ASSERT_FALSE(dictionary.ContainsKey(11));
+        ASSERT_EQ(dictionary[10], 20);
+        ASSERT_THROW(dictionary.AddValue(10, 0), core::Exception);
+        std::vector<int> keys = dictionary.GetAllKeys();
+        ASSERT_EQ(keys.size(), 2000u);
+        std::sort(keys.begin(), keys.end());
+        ASSERT_EQ(keys.front(), 0);
+        ASSERT_EQ(keys.back(), 3998);
+
+        std::vector<std::pair<int, int>> pairs;
+        for(int key = 4000; key < 5000; key++)
+            pairs.emplace_back(key, key * 2);
+        pairs.emplace_back(10, 0);
+        ASSERT_EQ(dictionary.AddValues(pairs), 1000u);
+        ASSERT_EQ(dictionary[10], 20);
+        std::vector<int> expired;
+        std::size_t visited = 0;
+        dictionary.Visit([&expired, &visited](int key, int value){
+            ASSERT_EQ(value, key * 2);
+            visited++;
+            if(key >= 4500)
+                expired.push_back(key);
+        });
+        ASSERT_EQ(visited, 3000u);
+        expired.push_back(1);
+        ASSERT_EQ(dictionary.RemoveValues(expired), 500u);
+        ASSERT_EQ(dictionary.GetAllKeys().size(), 2500u);
+        ASSERT_FALSE(dictionary.ContainsKey(4500));
+        ASSERT_TRUE(dictionary.ContainsKey(4499));
+    }
+    
+    std::atomic<int> retiredDeleted(0);
+
+    void DeleteRetired(void* object)
+    {
+        delete static_cast<int*>(object);
+        retiredDeleted++;
+    }
+
+    TEST(Core, ConcurrentHashMap)
+    {
+        core::ConcurrentHashMap<int, std::string> map(4);
+        for(int key = 0; key < 1000; key++)
+            map.AddValue(key, std::to_string(key));
+        ASSERT_THROW(map.AddValue(10, ""), core::Exception);
+
+        std::atomic<bool> done(false);
+        std::atomic<bool> torn(false);
+        std::vector<std::unique_ptr<core::Thread>> readers;
+        for(int idx = 0; idx < 3; idx++)
+            readers.emplace_back(new core::Thread("Reader", [&map, &done, &torn]{
+                while(done.load() == false)
+                    for(int key = 0; key < 2000; key++)
+                        map.Visit(key, [&torn, key](const std::string& value){
+                            if(value != std::to_string(key) && value != std::to_string(-key))
+                                torn = true;
+                        });
+            }));
+        core::Thread writer("Writer", [&map]{
+            for(int round = 0; round < 5; round++)
+            {
+                for(int key = 0; key < 2000; key++)
+                    map.SetValue(key, std::to_string(round % 2 ? -key : key));
+                for(int key = 1000; key < 2000; key++)
+                    ASSERT_TRUE(map.RemoveValue(key));
+            }
+        });
+        writer.join();
+        done = true;
+        for(auto& reader : readers)
+            reader->join();
+
+        ASSERT_FALSE(torn.load());
+        std::string value;
+        ASSERT_TRUE(map.Find(7, value));
+        ASSERT_EQ(value, "7");
+        ASSERT_FALSE(map.Find(1500, value));
+        ASSERT_FALSE(map.ContainsKey(1500));
+        ASSERT_FALSE(map.RemoveValue(1500));
+        //Retired objects are deleted once no reader may observe them, the calling thread's as well as those left
+        //behind by exited threads
+        retiredDeleted = 0;
+        std::size_t pending = core::Epoch::GetPendingCount();
+        {
+            core::Epoch::Guard guard;
+            for(int idx = 0; idx < 10; idx++)
+                core::Epoch::Retire(new int(idx), &DeleteRetired);
+            ASSERT_EQ(core::Epoch::GetPendingCount(), pending + 10);
+            core::Thread retirer("Retirer", []{
+                for(int idx = 0; idx < 10; idx++)
+                    core::Epoch::Retire(new int(idx), &DeleteRetired);
+                core::Epoch::Collect();
+            });
+            retirer.join();
+            for(int attempt = 0; attempt < 3; attempt++)
+                core::Epoch::Collect();
+            ASSERT_EQ(retiredDeleted.load(), 0); //Our own critical section holds the epoch back
+            ASSERT_GE(core::Epoch::GetPendingCount(), 10u);
+        }
+        for(int attempt = 0; attempt < 3; attempt++)
+            core::Epoch::Collect();
+        ASSERT_EQ(retiredDeleted.load(), 20);
+        ASSERT_EQ(core::Epoch::GetPendingCount(), 0u);
+    }
+    
+    TEST(Core, ConcurrentCache)
+    {
+        core::ConcurrentCache<int, int> cache(8, std::chrono::milliseconds::zero(), 1);
+        for(int key = 0; key < 8; key++)
+            cache.SetValue(key, key);
+        int value = 0;
+        ASSERT_TRUE(cache.TryGetValue(0, value)); //0 is referenced, the clock spares it
+        ASSERT_EQ(value, 0);
+        for(int key = 8; key < 12; key++)
+            cache.SetValue(key, key);
+        ASSERT_EQ(cache.GetSize(), 8u);
+        ASSERT_TRUE(cache.TryGetValue(0, value));
+        ASSERT_TRUE(cache.RemoveValue(0));
+        ASSERT_FALSE(cache.TryGetValue(0, value));
+        core::ConcurrentCache<int, int>::Statistics statistics = cache.GetStatistics();
+        ASSERT_EQ(statistics.hits, 2u);
+        ASSERT_EQ(statistics.misses, 1u);
+        ASSERT_EQ(statistics.evictions, 4u);
+
+        cache.SetValue(100, 100, std::chrono::milliseconds(20));
+        ASSERT_TRUE(cache.TryGetValue(100, value));
+        std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        ASSERT_FALSE(cache.TryGetValue(100, value));
+
+        //Concurrent misses of a key are coalesced into a single load
+        std::atomic<int> loads(0);
+        std::vector<std::unique_ptr<core::Thread>> threads;
+        for(int idx = 0; idx < 4; idx++)
+            threads.emplace_back(new core::Thread("Loader", [&cache, &loads]{
+                int loaded = cache.GetOrCompute(200, [&loads]{
+                    loads++;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                    return 400;
+                });
+                ASSERT_EQ(loaded, 400);
+            }));
+        for(auto& thread : threads)
+            thread->join();
+        ASSERT_EQ(loads.load(), 1);
+        ASSERT_EQ(cache.GetOrCompute(200, []{ return 0; }), 400);
+        ASSERT_THROW(cache.GetOrCompute(300, []() -> int { throw core::Exception(__CORE_SOURCE, "Load failed"); }), core::Exception);
+        ASSERT_FALSE(cache.TryGetValue(300, value));
+
+        //A value set or removed while the key is loaded isn't overwritten by the load
+        ASSERT_EQ(cache.GetOrCompute(500, [&cache]{
+            cache.SetValue(500, 501);
+            return 500;
+        }), 500);
+        ASSERT_TRUE(cache.TryGetValue(500, value));
+        ASSERT_EQ(value, 501);
+        ASSERT_EQ(cache.GetOrCompute(600, [&cache]{
+            cache.SetValue(600, 601);
+            cache.RemoveValue(600);
+            return 600;
+        }), 600);
+        ASSERT_FALSE(cache.TryGetValue(600, value));
+
+        //Values need not be default constructible
+        struct Handle
+        {
+            explicit Handle(int id): id(id){}
+            int id;
+        };
+        core::ConcurrentCache<int, Handle> handles(4, std::chrono::milliseconds::zero(), 1);
+        ASSERT_EQ(handles.GetOrCompute(1, []{ return Handle(10); }).id, 10);
+        ASSERT_EQ(handles.GetOrCompute(1, []{ return Handle(20); }).id, 10);
+        ASSERT_EQ(handles.GetStatistics().hits, 1u);
+        ASSERT_EQ(handles.GetStatistics().misses, 1u);
+
+        //The shards' capacities add up to the cache's, shards are never left without room
+        core::ConcurrentCache<int, int> shardedCache(10, std::chrono::milliseconds::zero(), 4);
+        for(int key = 0; key < 1000; key++)
+            shardedCache.SetValue(key, key);
+        ASSERT_EQ(shardedCache.GetSize(), 10u);
+        core::ConcurrentCache<int, int> smallCache(3, std::chrono::milliseconds::zero(), 16);
+        ASSERT_EQ(smallCache.GetShardsCount(), 2u);
+        for(int key = 0; key < 1000; key++)
+            smallCache.SetValue(key, key);
+        ASSERT_EQ(smallCache.GetSize(), 3u);
+
+        //Expired entries are evicted before the clock sweeps the live ones, even unreferenced
+        core::ConcurrentCache<int, int> expiringCache(2, std::chrono::milliseconds::zero(), 1);
+        expiringCache.SetValue(1, 1);
+        expiringCache.SetValue(2, 2, std::chrono::milliseconds(20));
+        ASSERT_TRUE(expiringCache.TryGetValue(2, value));
+        std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        expiringCache.SetValue(3, 3);
+        ASSERT_TRUE(expiringCache.TryGetValue(1, value));
+        ASSERT_TRUE(expiringCache.TryGetValue(3, value));
+        statistics = expiringCache.GetStatistics();
+        ASSERT_EQ(statistics.expirations, 1u);
+        ASSERT_EQ(statistics.evictions, 0u);
+    }
+    
+    std::vector<std::string> ReadLines(int descriptor)
+    {
+        std::string output;
+        char buffer[4096];
+        ssize_t size;
+        while((size = ::read(descriptor, buffer, sizeof(buffer))) > 0)
+            output.append(buffer, size);
+        std::vector<std::string> lines;
+        std::istringstream stream(output);
+        for(std::string line; std::getline(stream, line); )
+            lines.push_back(line);
+        return lines;
+    }
+
+    TEST(Core, DefaultLogger)
+    {
+        {
+            core::Pipe pipe;
+            std::vector<std::string> lines;
+            core::Thread reader("Reader", [&pipe, &lines]{ lines = ReadLines(pipe.GetReadDescriptor()); });
+            {
+                core::DefaultLogger logger(pipe.GetWriteDescriptor(), core::DefaultLogger::OverflowPolicy::BLOCK, 64);
+                logger.Start(core::TraceSeverity::Info);
+                std::vector<std::unique_ptr<core::Thread>> threads;
+                for(int idx = 0; idx < 4; idx++)
+                    threads.emplace_back(new core::Thread("Logger", [&logger, idx]{
+                        for(int line = 0; line < 1000; line++)
+                            logger.Log(core::TraceSeverity::Info, std::to_string(idx) + " " + std::to_string(line) + std::string(line % 200, '.'));
+                        logger.Log(core::TraceSeverity::Verbose, "filtered");
+                    }));
+                for(auto& thread : threads)
+                    thread->join();
+                logger.Flush();
+                ASSERT_EQ(logger.GetDroppedCount(), 0u);
+            }
+            pipe.CloseWriteDescriptor();
+            reader.join();
+            ASSERT_EQ(lines.size(), 4000u);
+            std::vector<int> next(4, 0);
+            for(std::string line : lines)
+            {
+                line = line.substr(line.find('\t') + 1); //Past the time stamp
+                int idx = 0, number = 0;
+                ASSERT_EQ(std::sscanf(line.c_str(), "%d %d", &idx, &number), 2);
+                ASSERT_EQ(number, next[idx]++); //A thread's messages keep their order
+                ASSERT_EQ(line.size(), std::to_string(idx).size() + 1 + std::to_string(number).size() + number % 200);
+            }
+        }
+        {
+            //Nobody reads the pipe until the logging is done, the writer blocks once the pipe fills up, then the ring does
+            core::Pipe pipe;
+            std::vector<std::string> lines;
+            std::uint64_t dropped = 0;
+            {
+                core::DefaultLogger logger(pipe.GetWriteDescriptor(), core::DefaultLogger::OverflowPolicy::DROP, 64);
+                logger.Start(core::TraceSeverity::Info);
+                for(int line = 0; line < 20000; line++)
+                    logger.Log(core::TraceSeverity::Info, std::string(100, 'x'));
+                core::Thread reader("Reader", [&pipe, &lines]{ lines = ReadLines(pipe.GetReadDescriptor()); });
+                logger.Flush();
+                dropped = logger.GetDroppedCount();
+                ASSERT_GT(dropped, 0u);
+                pipe.CloseWriteDescriptor();
+                reader.join();
+            }
+            ASSERT_EQ(lines.size() + dropped, 20000u);
+        }
+        {
+            //A child forked while the writer is busy logs and flushes through a writer of its own
+            core::Pipe pipe;
+            std::vector<std::string> lines;
+            core::Thread reader("Reader", [&pipe, &lines]{ lines = ReadLines(pipe.GetReadDescriptor()); });
+            {
+                core::DefaultLogger logger(pipe.GetWriteDescriptor(), core::DefaultLogger::OverflowPolicy::BLOCK, 64);
+                logger.Start(core::TraceSeverity::Info);
+                std::atomic<bool> done(false);
+                core::Thread parentLogger("Logger", [&logger, &done]{
+                    while(done.load() == false)
+                        logger.Log(core::TraceSeverity::Info, "parent " + std::string(100, '.'));
+                });
+                for(int round = 0; round < 3; round++)
+                {
+                    std::function<void(void)> func = [&logger, round]{
+                        for(int line = 0; line < 100; line++)
+                            logger.Log(core::TraceSeverity::Info, "child " + std::to_string(round) + " " + std::to_string(line));
+                        logger.Flush();
+                    };
+                    core::ChildProcess child = core::Process::SpawnChildProcess(func);
+                    child.wait();
+                }
+                done = true;
+                parentLogger.join();
+                logger.Flush();
+            }
+            pipe.CloseWriteDescriptor();
+            reader.join();
+            std::vector<int> next(3, 0);
+            for(std::string line : lines)
+            {
+                line = line.substr(line.find('\t') + 1);
+                int round = 0, number = 0;
+                if(std::sscanf(line.c_str(), "child %d %d", &round, &number) == 2)
+                    ASSERT_EQ(number, next[round]++);
+            }
+            ASSERT_EQ(next, std::vector<int>(3, 100));
+        }
+        {
+            //A reset ring drops whatever it held, consumed or not, and starts over
+            core::LogRing ring(16);
+            for(int idx = 0; idx < 10; idx++)
+                ASSERT_TRUE(ring.TryPush(0, "stale", 5));
+            ring.Consume([](std::uint32_t, const char*, std::size_t){});
+            for(int idx = 0; idx < 3; idx++)
+                ASSERT_TRUE(ring.TryPush(0, "stale", 5));
+            ring.Reset();
+            ASSERT_EQ(ring.GetTail(), 0u);
+            ASSERT_EQ(ring.GetConsumed(), 0u);
+            for(int idx = 0; idx < 16; idx++)
+                ASSERT_TRUE(ring.TryPush(0, "fresh", 5));
+            std::vector<std::string> records;
+            ring.Consume([&records](std::uint32_t, const char* data, std::size_t size){ records.emplace_back(data, size); });
+            ASSERT_EQ(records, std::vector<std::string>(16, "fresh"));
+        }
+    }
+    
+    TEST(Core, DeferredTrace)
+    {
+        core::Source source = __CORE_SOURCE;
+        std::vector<char> record;
+        {
+            std::string temporary("temporary");
+            const char* null = nullptr;
+            record.resize(core::DeferredRecord<int, const char*, double, const char*, char>::Size(-7, temporary.c_str(), 2.5, null, 'c'));
+            core::DeferredRecord<int, const char*, double, const char*, char>::Encode(record.data(), source, "%d %s %.2f %s %c", 0,
+                -7, temporary.c_str(), 2.5, null, 'c');
+        } //The record holds its own copy of the string
+        std::string message;
+        core::FormatDeferredRecord(record.data(), message);
+        ASSERT_EQ(message, core::Logger::BuildMessage(source, "%d %s %.2f %s %c", -7, "temporary", 2.5, (const char*)nullptr, 'c'));
+        {
+            unsigned char text[] = "unsigned";
+            unsigned char* pointer = text;
+            record.resize(core::DeferredRecord<unsigned char*>::Size(pointer));
+            core::DeferredRecord<unsigned char*>::Encode(record.data(), source, "%s", 0, pointer);
+            text[0] = 'x';
+        } //Any char flavour is copied by content
+        core::FormatDeferredRecord(record.data(), message);
+        ASSERT_EQ(message, core::Logger::BuildMessage(source, "%s", "unsigned"));
+
+        core::Pipe pipe;
+        std::vector<std::string> lines;
+        core::Thread reader("Reader", [&pipe, &lines]{ lines = ReadLines(pipe.GetReadDescriptor()); });
+        {
+            core::DefaultLogger logger(pipe.GetWriteDescriptor());
+            logger.Start(core::TraceSeverity::Info);
+            for(int idx = 0; idx < 100; idx++)
+            {
+                std::string text = std::string(idx, 'x');
+                std::int64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+                record.resize(core::DeferredRecord<int, const char*>::Size(idx, text.c_str()));
+                core::DeferredRecord<int, const char*>::Encode(record.data(), source, "%d:%s", timestamp, idx, text.c_str());
+                logger.LogDeferred(core::TraceSeverity::Info, record.data(), record.size());
+            }
+            logger.Flush();
+        }
+        pipe.CloseWriteDescriptor();
+        reader.join();
+        ASSERT_EQ(lines.size(), 100u);
+        for(int idx = 0; idx < 100; idx++)
+            ASSERT_EQ(lines[idx].substr(lines[idx].find('\t') + 1), core::Logger::BuildMessage(source, "%d:%s", idx, std::string(idx, 'x').c_str()));
+
+        //The process' logger defers its traces by default, or formats them at the call site, both show up alike
+        core::Pipe loggerPipe;
+        std::vector<std::string> loggerLines;
+        core::Thread loggerReader("Reader", [&loggerPipe, &loggerLines]{ loggerLines = ReadLines(loggerPipe.GetReadDescriptor()); });
+        core::Logger& logger = core::Logger::Instance();
+        std::unique_ptr<core::DefaultLogger> pipeLogger(new core::DefaultLogger(loggerPipe.GetWriteDescriptor()));
+        pipeLogger->Start(core::TraceSeverity::Info);
+        logger.SetImpl(std::move(pipeLogger));
+        for(bool deferred : {true, false})
+        {
+            logger.SetDeferredFormatting(deferred);
+            for(int idx = 0; idx < 10; idx++)
+                logger.Trace(core::TraceSeverity::Info, source, "%d %s %s", idx, std::string(deferred ? "deferred" : "formatted").c_str(), "trace");
+        }
+        char array[16] = "array";
+        logger.TraceDeferred(core::TraceSeverity::Info, source, "%s %s", array, "literal"); //Decayed, copied by content
+        std::strcpy(array, "changed");
+        logger.Flush();
+        std::unique_ptr<core::DefaultLogger> defaultLogger(new core::DefaultLogger());
+        defaultLogger->Start(logger.GetSeverity());
+        logger.SetImpl(std::move(defaultLogger)); //Drains and releases the pipe's logger
+        loggerPipe.CloseWriteDescriptor();
+        loggerReader.join();
+        ASSERT_EQ(loggerLines.size(), 21u);
+        for(int idx = 0; idx < 20; idx++)
+            ASSERT_EQ(loggerLines[idx].substr(loggerLines[idx].find('\t') + 1), core::Logger::BuildMessage(source, "%d %s %s",
+                idx % 10, idx < 10 ? "deferred" : "formatted", "trace"));
+        ASSERT_EQ(loggerLines[20].substr(loggerLines[20].find('\t') + 1), core::Logger::BuildMessage(source, "%s %s", "array", "literal"));
+    }
+    
+    TEST(Core, UnixSocket)
+    {
+        const std::string path = "/tmp/Core_UnixSocket_Test";
+        ::unlink(path.c_str());
+        {
+            core::MappedFile file(path, core::SharedObject::AccessMod::READ_WRITE, true);
+        }
+        ASSERT_THROW(core::UnixSocket::Listen(path), core::Exception); //Not a socket, left intact
+        ASSERT_EQ(::access(path.c_str(), F_OK), 0);
+        ::unlink(path.c_str());
+        {
+            core::UnixSocket stale = core::UnixSocket::Listen(path);
+        }
+        core::UnixSocket listener = core::UnixSocket::Listen(path); //Replaces the stale socket
+        core::UnixSocket client = core::UnixSocket::Connect(path);
+        core::UnixSocket server = listener.Accept();
+        ASSERT_THROW(core::UnixSocket::Listen(path), core::Exception); //Doesn't take over a live listener
+        client.SendDescriptor(client.GetDescriptor());
+        int descriptor = server.ReceiveDescriptor();
+        ASSERT_NE(descriptor, -1);
+        ::close(descriptor);
+
+        //A message carrying more descriptors than the receiver expects is reported, not silently truncated
+        for(int count = 2; count <= 3; count++)
+        {
+            std::vector<int> descriptors(count, client.GetDescriptor());
+            char payload = 0;
+            iovec io = {&payload, sizeof(payload)};
+            char control[CMSG_SPACE(3 * sizeof(int))];
+            memset(control, 0, sizeof(control));
+            msghdr message;
+            memset(&message, 0, sizeof(message));
+            message.msg_iov = &io;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = CMSG_SPACE(descriptors.size() * sizeof(int));
+            cmsghdr* header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET;
+            header->cmsg_type = SCM_RIGHTS;
+            header->cmsg_len = CMSG_LEN(descriptors.size() * sizeof(int));
+            memcpy(CMSG_DATA(header), descriptors.data(), descriptors.size() * sizeof(int));
+            ASSERT_EQ(::sendmsg(client.GetDescriptor(), &message, MSG_NOSIGNAL), 1);
+            ASSERT_THROW(server.ReceiveDescriptor(), core::Exception);
+        }
+        ::unlink(path.c_str());
+    }
+    
     TEST(Core, SyncSharedQueue)
     {
         std::function<void(void)> func = []{
@@ -229,6 +1319,46 @@ namespace coreTest
         }
     }
     
+    TEST(Core, BroadcastRing)
+    {
+        typedef core::BroadcastRing<int, 1024> ring_type;
+        ring_type ring("Core_Test_BroadcastRing", true, core::SharedObject::AccessMod::READ_WRITE);
+        std::function<void(void)> func = []{
+            ring_type ring("Core_Test_BroadcastRing", false, core::SharedObject::AccessMod::READ_WRITE);
+            for(int idx = 1; idx <= 1000; idx++)
+                ring.publish(idx);
+        };
+        
+        auto read_f = [&ring]{
+            ring_type::Reader reader = ring.make_reader();
+            int expected = 1, item = 0;
+            while(item != 1000)
+            {
+                ASSERT_EQ(ring.read(reader, item), ring_type::ReadStatus::OK);
+                ASSERT_EQ(item, expected++);
+            }
+        };
+        std::vector<std::unique_ptr<core::Thread>> readers;
+        for(int idx = 0; idx < 3; idx++)
+            readers.emplace_back(new core::Thread("Reader", read_f));
+        std::this_thread::sleep_for(100ms); //Let the readers register their cursors before publishing
+        core::ChildProcess process = core::Process::SpawnChildProcess(func);
+        for(auto& reader : readers)
+            reader->join();
+        process.wait();
+        
+        alignas(64) static char buffer[ring_type::chunk_size()];
+        ring_type localRing(buffer, true);
+        ring_type::Reader reader = localRing.make_reader();
+        for(int idx = 0; idx < 2000; idx++)
+            localRing.publish(idx);
+        int item = 0;
+        ASSERT_EQ(localRing.try_read(reader, item), ring_type::ReadStatus::OVERRUN);
+        ASSERT_EQ(localRing.try_read(reader, item), ring_type::ReadStatus::OK);
+        ASSERT_EQ(item, 2000 - 1024 + 1);
+        ASSERT_EQ(reader.GetLostCount(), 2000 - 1024 + 1);
+    }
+    
     TEST(Core, ProcessAsyncExecutor)
     {
         auto executor = core::AsyncExecutor<core::ExecutionModel::Process, 10>::make_executor("Core_Test_ProcessAsyncExecutor", true);